@@ -0,0 +1,71 @@
+#ifndef ADVERTISING_SCHEDULER_H
+#define ADVERTISING_SCHEDULER_H
+
+#include <stdint.h>
+
+// --- Advertising phases ---
+// P(name, interval (0.625ms units), duration in ms (0 = until connected))
+// After boot or a disconnect the watch advertises fast so a scanning host
+// finds it within its first scan window, then backs off step by step.
+// A restart while other centrals stay connected goes straight to the last
+// phase.
+#ifndef ADVERTISING_PHASES
+#define ADVERTISING_PHASES(P)                                   \
+  P(FAST, 48, 30000)   /* 30ms for 30s */                       \
+  P(MEDIUM, 160, 60000) /* 100ms for the next minute */         \
+  P(SLOW, 1636, 0)     /* 1022.5ms from then on */
+#endif
+
+enum AdvertisingPhaseId : uint8_t
+{
+#define ADVERTISING_PHASE_ID(name, interval, duration) ADV_PHASE_##name,
+  ADVERTISING_PHASES(ADVERTISING_PHASE_ID)
+#undef ADVERTISING_PHASE_ID
+  ADV_PHASE_COUNT
+};
+
+#define ADVERTISING_PHASE_CHECK(name, interval, duration) \
+  static_assert((interval) >= 32 && (interval) <= 16384, "Advertising phase " #name " interval out of range (20ms..10.24s)");
+ADVERTISING_PHASES(ADVERTISING_PHASE_CHECK)
+#undef ADVERTISING_PHASE_CHECK
+
+struct AdvertisingStats
+{
+  uint32_t starts;                          // Successful advertise() calls
+  uint32_t failures;                        // advertise() calls the stack refused
+  uint32_t connections[ADV_PHASE_COUNT];    // Links made while in each phase
+  uint32_t millisInPhase[ADV_PHASE_COUNT];  // Time spent advertising in each phase
+};
+
+class AdvertisingScheduler
+{
+public:
+  AdvertisingScheduler();
+
+  // (Re)starts advertising, in the first phase or (burst = false) the last.
+  // Returns ms until the next phase step, 0 if none is due or it failed.
+  unsigned long start(bool burst, unsigned long nowMillis);
+  // Moves to the next phase; same return value as start()
+  unsigned long step(unsigned long nowMillis);
+  // Advertising ended: by a new link (connected = true) or stopAdvertise()
+  void stopped(bool connected, unsigned long nowMillis);
+  // Puts changed advertising data on air, keeping the current phase
+  void refresh();
+
+  bool active() const { return _active; }
+  AdvertisingPhaseId phase() const { return (AdvertisingPhaseId)_phase; }
+  const AdvertisingStats &stats() const { return _stats; }
+  // stats().millisInPhase[phase] plus the running stretch of the current phase
+  uint32_t millisInPhase(uint8_t phase, unsigned long nowMillis) const;
+
+private:
+  unsigned long enterPhase(uint8_t phase, unsigned long nowMillis);
+  void accountPhase(unsigned long nowMillis);
+
+  bool _active;
+  uint8_t _phase;
+  unsigned long _phaseStartMillis;
+  AdvertisingStats _stats;
+};
+
+#endif
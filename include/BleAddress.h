@@ -0,0 +1,27 @@
+#ifndef BLE_ADDRESS_H
+#define BLE_ADDRESS_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define BLE_ADDRESS_SIZE 6
+#define BLE_ADDRESS_STRING_SIZE 18 // "aa:bb:cc:dd:ee:ff" and the terminator
+
+// A 48-bit device address held by value: copied, compared and formatted
+// without touching the heap. The bytes are little-endian, as the stack keeps
+// them; the text form puts the most significant byte first.
+struct BleAddress
+{
+  uint8_t bytes[BLE_ADDRESS_SIZE];
+
+  bool isNull() const;
+  bool operator==(const BleAddress &rhs) const { return memcmp(bytes, rhs.bytes, BLE_ADDRESS_SIZE) == 0; }
+  bool operator!=(const BleAddress &rhs) const { return !(*this == rhs); }
+
+  // Writes the text form into text; returns text
+  char *format(char text[BLE_ADDRESS_STRING_SIZE]) const;
+  // Parses the text form (either case); false, leaving address alone, on anything else
+  static bool parse(const char *text, BleAddress &address);
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef CALENDAR_H
+#define CALENDAR_H
+
+#include <stdint.h>
+
+// Header-only proleptic Gregorian calendar helpers. Every conversion is O(1)
+// (no per-year or per-month loops) and usable in constant expressions, so the
+// same code runs in the firmware and in a host build.
+//
+// Day numbers count days since 1970-01-01 and are unsigned, which covers
+// every date the CTS Current Time year field (1582..9999) can encode after 1970.
+
+namespace Calendar
+{
+
+// Days before each month in a March-based year (Mar = 0 ... Feb = 11).
+// Starting the year in March puts the leap day at the very end, so the
+// table is the same for leap and common years.
+constexpr uint16_t kDaysBeforeMonthFromMarch[12] = {
+    0, 31, 61, 92, 122, 153, 184, 214, 245, 275, 306, 337};
+
+constexpr uint8_t kDaysInMonth[13] = {
+    0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+constexpr uint32_t kDaysPerEra = 146097;     // 400 Gregorian years
+constexpr uint32_t kEpochShift = 719468;     // 0000-03-01 -> 1970-01-01
+
+// Leap test without branches: divisible by 4, and either not by 100 or by 400.
+// For multiples of 4, "% 100" reduces to "% 25" and "% 400" to "& 15".
+constexpr bool isLeapYear(uint16_t year)
+{
+  return ((year & 3) == 0) & (((year % 25) != 0) | ((year & 15) == 0));
+}
+
+constexpr uint8_t daysInMonth(uint16_t year, uint8_t month)
+{
+  return kDaysInMonth[month] + (month == 2 ? isLeapYear(year) : 0);
+}
+
+// Days since 1970-01-01 for a valid civil date (year >= 1970)
+constexpr uint32_t daysFromCivil(uint16_t year, uint8_t month, uint8_t day)
+{
+  uint32_t y = year - (month <= 2);
+  uint32_t era = y / 400;
+  uint32_t yearOfEra = y - era * 400;
+  uint32_t dayOfYear = kDaysBeforeMonthFromMarch[month > 2 ? month - 3 : month + 9] + day - 1;
+  uint32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * kDaysPerEra + dayOfEra - kEpochShift;
+}
+
+struct CivilDate
+{
+  uint16_t year;
+  uint8_t month;
+  uint8_t day;
+};
+
+constexpr CivilDate civilFromDays(uint32_t days)
+{
+  uint32_t z = days + kEpochShift;
+  uint32_t era = z / kDaysPerEra;
+  uint32_t dayOfEra = z - era * kDaysPerEra;
+  uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+  uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  uint32_t monthFromMarch = (5 * dayOfYear + 2) / 153;
+  uint8_t day = dayOfYear - kDaysBeforeMonthFromMarch[monthFromMarch] + 1;
+  uint8_t month = monthFromMarch < 10 ? monthFromMarch + 3 : monthFromMarch - 9;
+  uint16_t year = yearOfEra + era * 400 + (month <= 2);
+  return CivilDate{year, month, day};
+}
+
+// ISO weekday, 1 = Monday ... 7 = Sunday (1970-01-01 was a Thursday)
+constexpr uint8_t weekdayFromDays(uint32_t days)
+{
+  return ((days + 3) % 7) + 1;
+}
+
+static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch origin");
+static_assert(daysFromCivil(2000, 3, 1) == 11017, "leap century");
+static_assert(daysFromCivil(2024, 1, 1) == 19723, "2024-01-01");
+static_assert(civilFromDays(19723).year == 2024 && civilFromDays(19723).month == 1 &&
+                  civilFromDays(19723).day == 1,
+              "round trip");
+static_assert(civilFromDays(11016).month == 2 && civilFromDays(11016).day == 29, "2000-02-29");
+static_assert(weekdayFromDays(19723) == 1, "2024-01-01 was a Monday");
+static_assert(!isLeapYear(1900) && isLeapYear(2000) && isLeapYear(2024) && !isLeapYear(2100),
+              "leap rule");
+
+} // namespace Calendar
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef CONNECTION_PARAMS_H
+#define CONNECTION_PARAMS_H
+
+#include <stdint.h>
+#include "ConnectionTable.h"
+
+// --- Connection parameter profiles ---
+// P(name, min interval, max interval (1.25ms units), peripheral latency (events),
+//   supervision timeout (10ms units))
+// SYNC is what a new link asks for: short intervals so the time write and
+// the read-back complete in a few tens of milliseconds. Once a link has been
+// quiet for CONN_IDLE_AFTER_MS it is moved to IDLE: long interval, and the
+// watch may skip connection events while it has nothing to send.
+#ifndef CONNECTION_PROFILES
+#define CONNECTION_PROFILES(P)                                       \
+  P(SYNC, 6, 12, 0, 400)   /* 7.5-15ms, no latency, 4s timeout */    \
+  P(IDLE, 400, 800, 2, 800) /* 500-1000ms, skip 2 events, 8s timeout */
+#endif
+
+#ifndef CONN_IDLE_AFTER_MS
+#define CONN_IDLE_AFTER_MS 3000 // Quiet time before a link drops to the IDLE profile
+#endif
+
+enum ConnectionProfileId : uint8_t
+{
+#define CONNECTION_PROFILE_ID(name, minInterval, maxInterval, latency, timeout) CONN_PROFILE_##name,
+  CONNECTION_PROFILES(CONNECTION_PROFILE_ID)
+#undef CONNECTION_PROFILE_ID
+  CONN_PROFILE_COUNT
+};
+
+struct ConnectionProfile
+{
+  uint16_t minInterval;        // 1.25ms units
+  uint16_t maxInterval;        // 1.25ms units
+  uint16_t latency;            // Connection events the peripheral may skip
+  uint16_t supervisionTimeout; // 10ms units
+};
+
+// Core spec limits, including timeout > (1 + latency) * maxInterval * 2
+constexpr bool connectionProfileValid(uint16_t minInterval, uint16_t maxInterval, uint16_t latency, uint16_t timeout)
+{
+  return minInterval >= 6 && minInterval <= maxInterval && maxInterval <= 3200 &&
+         latency <= 499 && timeout >= 10 && timeout <= 3200 &&
+         (uint32_t)timeout * 10 * 100 > (1 + (uint32_t)latency) * maxInterval * 125 * 2;
+}
+
+#define CONNECTION_PROFILE_CHECK(name, minInterval, maxInterval, latency, timeout) \
+  static_assert(connectionProfileValid(minInterval, maxInterval, latency, timeout), "Connection profile " #name " is out of spec");
+CONNECTION_PROFILES(CONNECTION_PROFILE_CHECK)
+#undef CONNECTION_PROFILE_CHECK
+
+// Moves each connection between the profiles above. SYNC is also installed
+// as the preferred parameters, so the stack requests it when a link opens.
+class ConnectionParams
+{
+public:
+  explicit ConnectionParams(ConnectionTable &connections);
+
+  void begin();
+
+  // A central connected (starts in SYNC) or did something (restarts its quiet time)
+  void onConnected(CentralConnection &connection, unsigned long nowMillis);
+  void onActivity(const BleAddress &central, unsigned long nowMillis);
+
+  // Moves quiet links to IDLE. Returns the milliseconds until the next link
+  // may become idle, or 0 when every link is already idle.
+  unsigned long update(unsigned long nowMillis);
+
+  static const ConnectionProfile &profile(ConnectionProfileId id);
+
+private:
+  bool request(CentralConnection &connection, ConnectionProfileId id);
+
+  ConnectionTable &_connections;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef CONNECTION_TABLE_H
+#define CONNECTION_TABLE_H
+
+#include "BleAddress.h"
+
+// Concurrent centrals (e.g. phone, sync gateway, dashboard). Keep it within
+// the number of links the BLE stack is configured for.
+#ifndef MAX_CENTRALS
+#define MAX_CENTRALS 3
+#endif
+
+struct CentralConnection
+{
+  BleAddress address;
+  bool inUse;
+  bool subscribed; // Current Time notifications enabled by this central
+  uint8_t profile; // ConnectionProfileId last requested for the link
+  unsigned long lastActivityMillis;
+};
+
+// Fixed-capacity per-connection state. Characteristic values are shared by
+// all centrals, so a single writeValue() already fans a notification out to
+// every subscriber; the table only has to know whether anyone subscribed.
+class ConnectionTable
+{
+public:
+  ConnectionTable();
+
+  // Takes a free slot; NULL when the table is full
+  CentralConnection *add(const BleAddress &address);
+  CentralConnection *find(const BleAddress &address);
+  // Frees the address's slot; false if it was not in the table
+  bool remove(const BleAddress &address);
+
+  // Returns true when the subscriber count changed
+  bool setSubscribed(const BleAddress &address, bool subscribed);
+
+  uint8_t count() const { return _count; }
+  uint8_t subscriberCount() const { return _subscriberCount; }
+  bool full() const { return _count >= MAX_CENTRALS; }
+
+  // Slot access for iteration; check inUse
+  CentralConnection &slot(uint8_t index) { return _slots[index]; }
+
+private:
+  CentralConnection _slots[MAX_CENTRALS];
+  uint8_t _count;
+  uint8_t _subscriberCount;
+};
+
+#endif
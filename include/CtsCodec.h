@@ -0,0 +1,113 @@
+#ifndef CTS_CODEC_H
+#define CTS_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+#include "CtsSchema.h"
+
+// Header-only codec for the CTS characteristics described in CtsSchema.h.
+// Every packet type gets:
+//   - a plain struct with one member per field (aggregate-initialisable)
+//   - compile-time field offsets and WIRE_SIZE, checked against the schema
+//   - decode()/encode() to and from a byte buffer
+//   - a View that reads fields in place, e.g. over characteristic.value()
+// No Arduino dependency, so it builds (and can be fuzzed) natively.
+
+// --- Little-endian field access ---
+
+// Accumulator for a field: 32-bit unless the field needs 64
+template <typename T>
+struct CtsWord
+{
+  typedef typename std::conditional<sizeof(T) <= 4, uint32_t, uint64_t>::type type;
+};
+
+template <typename T>
+constexpr T ctsLoad(const uint8_t *data)
+{
+  static_assert(std::is_integral<T>::value && sizeof(T) <= 8, "CTS fields are 8/16/32/64-bit integers");
+  typename CtsWord<T>::type value = 0;
+  for (size_t i = 0; i < sizeof(T); i++)
+  {
+    value |= (typename CtsWord<T>::type)data[i] << (8 * i);
+  }
+  return (T)(typename std::make_unsigned<T>::type)value;
+}
+
+template <typename T>
+inline void ctsStore(uint8_t *data, T value)
+{
+  static_assert(std::is_integral<T>::value && sizeof(T) <= 8, "CTS fields are 8/16/32/64-bit integers");
+  typename CtsWord<T>::type bits = (typename std::make_unsigned<T>::type)value;
+  for (size_t i = 0; i < sizeof(T); i++)
+  {
+    data[i] = (uint8_t)(bits >> (8 * i));
+  }
+}
+
+// --- Packet definitions ---
+
+#define CTS_FIELD_MEMBER(type, name) type name;
+// Consecutive enumerators: name##Offset follows the previous field's last byte
+#define CTS_FIELD_OFFSET(type, name) name##Offset, name##Last = name##Offset + sizeof(type) - 1,
+#define CTS_FIELD_LOAD(type, name) packet.name = ctsLoad<type>(data + name##Offset);
+#define CTS_FIELD_STORE(type, name) ctsStore<type>(data + name##Offset, name);
+#define CTS_FIELD_GETTER(type, name) \
+  constexpr type name() const { return ctsLoad<type>(_data + name##Offset); }
+
+#define CTS_DEFINE_PACKET(Name, FIELDS, size)                                         \
+  struct Name                                                                         \
+  {                                                                                   \
+    FIELDS(CTS_FIELD_MEMBER)                                                          \
+                                                                                      \
+    enum Layout : size_t                                                              \
+    {                                                                                 \
+      FIELDS(CTS_FIELD_OFFSET)                                                        \
+      WIRE_SIZE                                                                       \
+    };                                                                                \
+                                                                                      \
+    static Name decode(const uint8_t *data)                                           \
+    {                                                                                 \
+      Name packet = {};                                                               \
+      FIELDS(CTS_FIELD_LOAD)                                                          \
+      return packet;                                                                  \
+    }                                                                                 \
+                                                                                      \
+    void encode(uint8_t *data) const { FIELDS(CTS_FIELD_STORE) }                      \
+                                                                                      \
+    /* Zero-copy accessor; the caller checks the length against WIRE_SIZE */         \
+    class View                                                                        \
+    {                                                                                 \
+    public:                                                                           \
+      explicit constexpr View(const uint8_t *data) : _data(data) {}                   \
+      FIELDS(CTS_FIELD_GETTER)                                                        \
+      constexpr const uint8_t *data() const { return _data; }                         \
+                                                                                      \
+    private:                                                                          \
+      const uint8_t *_data;                                                           \
+    };                                                                                \
+  };                                                                                  \
+  static_assert(Name::WIRE_SIZE == (size), #Name " does not match its CTS wire size");
+
+CTS_PACKETS(CTS_DEFINE_PACKET)
+
+#undef CTS_DEFINE_PACKET
+#undef CTS_FIELD_GETTER
+#undef CTS_FIELD_STORE
+#undef CTS_FIELD_LOAD
+#undef CTS_FIELD_OFFSET
+#undef CTS_FIELD_MEMBER
+
+// Known-answer check at compile time: 2024-02-29 12:34:56, Thursday, +128/256 s
+namespace CtsCodecCheck
+{
+  constexpr uint8_t kSample[CtsCurrentTime::WIRE_SIZE] = {0xE8, 0x07, 2, 29, 12, 34, 56, 4, 128, 1};
+  static_assert(CtsCurrentTime::View(kSample).year() == 2024, "CTS year is little-endian");
+  static_assert(CtsCurrentTime::View(kSample).dayOfWeek() == 4, "CTS field offsets");
+  static_assert(CtsCurrentTime::View(kSample).adjustReason() == 1, "CTS field offsets");
+  constexpr uint8_t kTimeZone[CtsLocalTimeInfo::WIRE_SIZE] = {0xE0, 0}; // UTC-8
+  static_assert(CtsLocalTimeInfo::View(kTimeZone).timeZone() == -32, "CTS time zone is signed");
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef CTS_SCHEMA_H
+#define CTS_SCHEMA_H
+
+// Wire layout of the Current Time Service characteristics, shared with
+// python_cts_client/gen_cts_structs.py (which parses this file to generate
+// cts_structs.py - keep one field per line). All fields are little-endian
+// and packed in the order listed.
+//
+// X(type, name)   type is one of int8_t/uint8_t/int16_t/uint16_t/int32_t/uint32_t/
+//                  int64_t/uint64_t
+
+// Current Time (0x2A2B)
+#define CTS_CURRENT_TIME_FIELDS(X) \
+  X(uint16_t, year)                \
+  X(uint8_t, month)                \
+  X(uint8_t, day)                  \
+  X(uint8_t, hour)                 \
+  X(uint8_t, minute)               \
+  X(uint8_t, second)               \
+  X(uint8_t, dayOfWeek)            \
+  X(uint8_t, fractions256)         \
+  X(uint8_t, adjustReason)
+
+// Adjust Reason bits (Current Time adjustReason)
+#define CTS_ADJUST_NONE 0x00
+#define CTS_ADJUST_MANUAL 0x01             // Manual time update
+#define CTS_ADJUST_EXTERNAL_REFERENCE 0x02 // External reference time update
+#define CTS_ADJUST_TIME_ZONE 0x04          // Change of time zone
+#define CTS_ADJUST_DST 0x08                // Change of DST offset
+#define CTS_ADJUST_MASK 0x0F               // Every defined bit
+
+// Local Time Information (0x2A0F)
+#define CTS_LOCAL_TIME_INFO_FIELDS(X) \
+  X(int8_t, timeZone)                 \
+  X(uint8_t, dstOffset)
+
+// Reference Time Information (0x2A14)
+#define CTS_REFERENCE_TIME_INFO_FIELDS(X) \
+  X(uint8_t, source)                      \
+  X(uint8_t, accuracy)                    \
+  X(uint8_t, daysSinceUpdate)             \
+  X(uint8_t, hoursSinceUpdate)
+
+// Time beacon: advertising manufacturer data after the company ID (not part
+// of CTS). Lets a host judge from a passive scan whether a sync is needed.
+#define CTS_TIME_BEACON_FIELDS(X) \
+  X(uint8_t, version)             \
+  X(uint32_t, epochSeconds)       \
+  X(uint32_t, secondsSinceSync)   \
+  X(int32_t, driftPpb)            \
+  X(uint16_t, errorEstimateMs)
+
+// Gateway time: manufacturer data a local gateway broadcasts to set the time
+// without a connection (see GatewayTime.h). tag is SipHash-2-4 over the
+// company ID and every field before it, keyed with the shared gateway key.
+#define CTS_GATEWAY_TIME_FIELDS(X) \
+  X(uint8_t, version)              \
+  X(uint32_t, sequence)            \
+  X(uint32_t, epochSeconds)        \
+  X(uint8_t, fractions256)         \
+  X(uint64_t, tag)
+
+// Diagnostics (custom service, see GattTable.h): counters since boot, the
+// links made and time spent in each advertising phase (ADVERTISING_PHASES in
+// AdvertisingScheduler.h) and, when built with CTS_PROFILER, the hot-path
+// probes of Profiler.h. A
+// histogram packs eight one-byte buckets, least significant first, each the
+// share of calls (out of 255) that took <1, 1-4, 4-16, 16-64, 64-256,
+// 256-1024, 1024-4096 and 4096 or more microseconds.
+#define CTS_DIAGNOSTICS_FIELDS(X)      \
+  X(uint8_t, version)                  \
+  X(uint8_t, flags)                    \
+  X(uint32_t, uptimeSeconds)           \
+  X(uint32_t, timeWritesAccepted)      \
+  X(uint32_t, timeWritesRejected)      \
+  X(uint32_t, notificationsSent)       \
+  X(uint32_t, connects)                \
+  X(uint32_t, disconnects)             \
+  X(uint32_t, advertisingStarts)       \
+  X(uint32_t, advertisingFailures)     \
+  X(uint32_t, schedulerOverruns)       \
+  X(uint32_t, logDropped)              \
+  X(uint32_t, bleEventsDropped)        \
+  X(uint32_t, gatewayTimesAccepted)    \
+  X(uint32_t, fastPhaseConnections)    \
+  X(uint32_t, fastPhaseSeconds)        \
+  X(uint32_t, mediumPhaseConnections)  \
+  X(uint32_t, mediumPhaseSeconds)      \
+  X(uint32_t, slowPhaseConnections)    \
+  X(uint32_t, slowPhaseSeconds)        \
+  X(uint32_t, updateTimeCalls)         \
+  X(uint16_t, updateTimeMaxMicros)     \
+  X(uint64_t, updateTimeHistogram)     \
+  X(uint32_t, writeTimeCalls)          \
+  X(uint16_t, writeTimeMaxMicros)      \
+  X(uint64_t, writeTimeHistogram)      \
+  X(uint32_t, timeWrittenCalls)        \
+  X(uint16_t, timeWrittenMaxMicros)    \
+  X(uint64_t, timeWrittenHistogram)    \
+  X(uint32_t, transportPollCalls)      \
+  X(uint16_t, transportPollMaxMicros)  \
+  X(uint64_t, transportPollHistogram)
+
+// P(struct name, field list, wire size in bytes)
+#define CTS_PACKETS(P)                                       \
+  P(CtsCurrentTime, CTS_CURRENT_TIME_FIELDS, 10)             \
+  P(CtsLocalTimeInfo, CTS_LOCAL_TIME_INFO_FIELDS, 2)         \
+  P(CtsReferenceTimeInfo, CTS_REFERENCE_TIME_INFO_FIELDS, 4) \
+  P(CtsTimeBeacon, CTS_TIME_BEACON_FIELDS, 15)             \
+  P(CtsGatewayTime, CTS_GATEWAY_TIME_FIELDS, 18)             \
+  P(CtsDiagnostics, CTS_DIAGNOSTICS_FIELDS, 130)
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef CURRENT_TIME_PARSER_H
+#define CURRENT_TIME_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// --- Accepted Current Time range ---
+#define CTS_YEAR_MIN 1970 // Day numbers start at the epoch (see Calendar.h)
+#define CTS_YEAR_MAX 9999 // Largest year the CTS Year field defines
+
+// Why a Current Time write was rejected (0 = accepted)
+enum CurrentTimeParseResult : uint8_t
+{
+  CURRENT_TIME_OK = 0,
+  CURRENT_TIME_BAD_LENGTH,
+  CURRENT_TIME_BAD_YEAR,
+  CURRENT_TIME_BAD_DATE,        // Month out of range or day past the end of that month
+  CURRENT_TIME_BAD_TIME,        // Hour, minute or second out of range
+  CURRENT_TIME_BAD_DAY_OF_WEEK  // Neither 0 (unknown) nor the weekday of the date
+};
+
+struct ParsedCurrentTime
+{
+  uint64_t epochSeconds;
+  uint8_t fractions256;
+  uint8_t adjustReason; // Adjust Reason bits as written, masked to the defined ones
+};
+
+// Validates a Current Time payload written by a client and converts it to
+// epoch seconds. Pure function of its input (no Arduino or BLE dependency),
+// so it can be driven with arbitrary payloads in a native build.
+// Cheap checks run first; no calendar math happens for a bad length.
+CurrentTimeParseResult parseCurrentTime(const uint8_t *data, size_t length, ParsedCurrentTime &parsed);
+
+#endif
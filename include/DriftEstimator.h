@@ -0,0 +1,48 @@
+#ifndef DRIFT_ESTIMATOR_H
+#define DRIFT_ESTIMATOR_H
+
+#include <stdint.h>
+#include "Timebase.h"
+
+#define DRIFT_HISTORY 8                                                 // Syncs kept for the fit
+#define DRIFT_MIN_SPAN_TICKS (3600ULL * TIMEBASE_TICKS_PER_SECOND)      // Fit only once syncs span 1 hour
+#define DRIFT_MAX_PPB 500000                                            // Clamp: +-500 ppm is far beyond any crystal
+#define DRIFT_STEP_TOLERANCE_TICKS (10LL * TIMEBASE_TICKS_PER_SECOND)   // Offsets beyond drift + 10 s are manual adjustments
+
+// Learns the local oscillator's frequency error from successive time syncs.
+// Each sync pairs the uncorrected local tick count with the reference time
+// the client wrote; a least-squares line through the last DRIFT_HISTORY
+// pairs gives the rate correction the clock should apply between syncs.
+class DriftEstimator
+{
+public:
+  DriftEstimator();
+
+  // rawTicks: EpochClock::rawTicks() at the sync
+  // referenceTicks: time written by the client
+  // offsetTicks: reference minus the (corrected) local time it replaced
+  void addSync(uint64_t rawTicks, uint64_t referenceTicks, int64_t offsetTicks);
+  void reset();
+
+  int32_t correctionPpb() const { return _correctionPpb; }
+  int64_t lastOffsetTicks() const { return _lastOffsetTicks; }
+  uint8_t sampleCount() const { return _count; }
+
+private:
+  struct Sample
+  {
+    uint64_t rawTicks;
+    uint64_t referenceTicks;
+  };
+
+  void clearHistory();
+  void estimate();
+
+  Sample _samples[DRIFT_HISTORY];
+  uint8_t _head;
+  uint8_t _count;
+  int32_t _correctionPpb;
+  int64_t _lastOffsetTicks;
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef EPOCH_CLOCK_H
+#define EPOCH_CLOCK_H
+
+#include <stdint.h>
+#include "Timebase.h"
+
+// --- Time Structure ---
+struct DateTime
+{
+  uint16_t year;
+  uint8_t month;
+  uint8_t day;
+  uint8_t hour;
+  uint8_t minute;
+  uint8_t second;
+  uint8_t dayOfWeek; // 1 = Monday, 7 = Sunday
+};
+
+// Sub-second resolution of the epoch counter (one tick per timebase tick)
+#define CLOCK_TICKS_PER_SECOND TIMEBASE_TICKS_PER_SECOND
+
+// Monotonic wall clock kept as a single 64-bit tick counter since
+// 1970-01-01 00:00:00. Advancing the clock is one subtraction and one add
+// (plus a shift-and-add when a drift correction is active); the calendar view
+// (DateTime) is only derived when someone asks for it and is cached until the
+// second changes. Plain data throughout, so a copy (see TimeState.h) keeps
+// working on its own.
+class EpochClock
+{
+public:
+  EpochClock(uint64_t epochSeconds = 0);
+
+  // Anchor the clock to the current timebaseNow() value without changing the time
+  void begin(uint32_t nowTicks);
+  // Advance the counter by the timebase ticks elapsed since the last call
+  void update(uint32_t nowTicks);
+  // Replace the current time as of timebase tick nowTicks
+  void set(const DateTime &dateTime, uint32_t nowTicks);
+  void setTicks(uint64_t ticks, uint32_t nowTicks);
+
+  // Rate correction applied on every update, in parts per billion of the
+  // elapsed local time (positive = local oscillator runs slow)
+  void setDriftCorrectionPpb(int32_t ppb);
+  int32_t driftCorrectionPpb() const { return _driftPpb; }
+
+  uint64_t ticks() const { return _ticks; }
+  // Uncorrected local ticks since begin(), unaffected by set()
+  uint64_t rawTicks() const { return _rawTicks; }
+  uint64_t epochSeconds() const { return _ticks / CLOCK_TICKS_PER_SECOND; }
+  // Sub-second phase in 1/256 s units (CTS Fractions256)
+  uint8_t fractions256() const { return (_ticks % CLOCK_TICKS_PER_SECOND) * 256 / CLOCK_TICKS_PER_SECOND; }
+
+  static uint64_t ticksFromFractions256(uint8_t fractions256)
+  {
+    return ((uint32_t)fractions256 * CLOCK_TICKS_PER_SECOND + 128) / 256;
+  }
+  // Calendar view of the current second (lazily derived)
+  const DateTime &dateTime();
+
+  static uint64_t toEpochSeconds(const DateTime &dateTime);
+  static DateTime fromEpochSeconds(uint64_t epochSeconds);
+
+private:
+  uint64_t _ticks;
+  uint64_t _rawTicks;
+  uint32_t _lastTimebaseTicks;
+
+  int32_t _driftPpb;
+  int64_t _driftRateQ32;  // Correction per tick, 32.32 fixed point
+  int64_t _driftResidue;  // Fractional ticks not yet applied, 32.32 fixed point
+
+  uint64_t _cachedSeconds;
+  DateTime _cachedDateTime;
+  bool _cacheValid;
+};
+
+#endif
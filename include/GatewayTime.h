@@ -0,0 +1,68 @@
+#ifndef GATEWAY_TIME_H
+#define GATEWAY_TIME_H
+
+#include <stdint.h>
+#include "CtsCodec.h"
+#include "CurrentTimeParser.h"
+#include "SipHash.h"
+
+// --- Gateway time broadcast ---
+#define GATEWAY_TIME_VERSION 1
+#define GATEWAY_TIME_COMPANY_ID 0xFFFF // Same testing ID as the time beacon; the length tells them apart
+#define GATEWAY_TIME_LENGTH (2 + CtsGatewayTime::WIRE_SIZE) // Manufacturer data: company ID, then the packet
+#define GATEWAY_TIME_SIGNED_LENGTH (2 + CtsGatewayTime::tagOffset) // Bytes covered by the tag
+#ifndef GATEWAY_TIME_MAX_STEP_S
+#define GATEWAY_TIME_MAX_STEP_S 600 // Largest step a broadcast may make to a synced clock
+#endif
+#ifndef GATEWAY_TIME_KEY
+// Development key shared with python_cts_client/gateway.py. It is public,
+// so hardware builds with CTS_GATEWAY_TIME must pass their own, e.g.
+// -DGATEWAY_TIME_KEY="{0x3a, 0x91, ...}" (checked in main.cpp)
+#define GATEWAY_TIME_DEVELOPMENT_KEY 1
+#define GATEWAY_TIME_KEY {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, \
+                          0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f}
+#endif
+
+// What became of a received advertisement (0 = accepted)
+enum GatewayTimeResult : uint8_t
+{
+  GATEWAY_TIME_OK = 0,
+  GATEWAY_TIME_NOT_GATEWAY,   // Other manufacturer data; ignored silently
+  GATEWAY_TIME_REPEATED,      // Sequence not newer than the last accepted one (resent or replayed)
+  GATEWAY_TIME_OUT_OF_WINDOW, // Stamp too far from local time, or before it when not synced (replayed)
+  GATEWAY_TIME_BAD_TAG        // Looked like a gateway broadcast but was not signed with our key
+};
+
+// Checks time broadcasts from a local gateway, so the watch can be set from
+// a passive scan without ever forming a connection. A broadcast carries the
+// gateway's time when it went on air, a sequence number that grows with
+// every new stamp and a SipHash-2-4 tag over both.
+//
+// A gateway repeats each packet for several advertising events; the
+// sequence and window checks come before the tag so those copies cost a
+// compare, not a hash. The last sequence is not persisted, so after a reset
+// the stamp itself has to stand in for it: a synced clock takes no step
+// larger than GATEWAY_TIME_MAX_STEP_S, and an unsynced one (still counting
+// from its initial time) never goes back. A replayed stamp can at most set
+// a freshly reset watch to a time between its initial one and now.
+class GatewayTimeReceiver
+{
+public:
+  explicit GatewayTimeReceiver(const uint8_t key[SIP_HASH_KEY_SIZE]);
+
+  // Checks a broadcast against the local clock (localSynced: set from a
+  // reference since boot). On GATEWAY_TIME_OK fills parsed (adjustReason is
+  // left to the caller) and remembers the sequence.
+  GatewayTimeResult accept(const uint8_t *manufacturerData, int length, uint64_t localEpochSeconds, bool localSynced,
+                           ParsedCurrentTime &parsed);
+
+  uint32_t lastSequence() const { return _lastSequence; }
+  uint32_t acceptedCount() const { return _acceptedCount; }
+
+private:
+  uint8_t _key[SIP_HASH_KEY_SIZE];
+  uint32_t _lastSequence;
+  uint32_t _acceptedCount;
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef GATT_TABLE_H
+#define GATT_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "CtsCodec.h"
+
+// Attribute table of the server. The transport (Transport.h) builds the
+// services from it and refers to characteristics by GattCharacteristicId,
+// so application code never holds stack objects.
+
+// Characteristic properties (Core spec bit values, same as ArduinoBLE's)
+#define GATT_READ 0x02
+#define GATT_WRITE 0x08
+#define GATT_NOTIFY 0x10
+
+// --- Services ---
+// S(name, UUID); the first one is advertised. DIAGNOSTICS is a custom
+// service the gateway reads for fleet health (CtsDiagnostics in CtsSchema.h).
+// Bluetooth SIG UUIDs are given in their 16-bit form, which is what goes in
+// the attribute table and the advertising packet (4 bytes instead of 18).
+#define GATT_SERVICES(S) \
+  S(CTS, "1805")         \
+  S(DIAGNOSTICS, "7D3E0001-5C1A-4B8E-9F2D-3A6C0E5B7F10")
+
+// --- Characteristics ---
+// C(name, service, UUID, properties, value size in bytes)
+#define GATT_CHARACTERISTICS(C)                                                                                                 \
+  C(CURRENT_TIME, CTS, "2A2B", GATT_READ | GATT_WRITE | GATT_NOTIFY, CtsCurrentTime::WIRE_SIZE)                \
+  C(LOCAL_TIME_INFO, CTS, "2A0F", GATT_READ, CtsLocalTimeInfo::WIRE_SIZE)                                      \
+  C(REFERENCE_TIME_INFO, CTS, "2A14", GATT_READ, CtsReferenceTimeInfo::WIRE_SIZE)                              \
+  C(DIAGNOSTICS, DIAGNOSTICS, "7D3E0002-5C1A-4B8E-9F2D-3A6C0E5B7F10", GATT_READ, CtsDiagnostics::WIRE_SIZE)
+
+enum GattServiceId : uint8_t
+{
+#define GATT_SERVICE_ID(name, uuid) GATT_SERVICE_##name,
+  GATT_SERVICES(GATT_SERVICE_ID)
+#undef GATT_SERVICE_ID
+  GATT_SERVICE_COUNT
+};
+
+enum GattCharacteristicId : uint8_t
+{
+#define GATT_CHARACTERISTIC_ID(name, service, uuid, properties, size) GATT_##name,
+  GATT_CHARACTERISTICS(GATT_CHARACTERISTIC_ID)
+#undef GATT_CHARACTERISTIC_ID
+  GATT_CHARACTERISTIC_COUNT
+};
+
+struct GattCharacteristicInfo
+{
+  GattServiceId service;
+  const char *uuid;
+  uint8_t properties;
+  uint16_t valueSize;
+};
+
+constexpr const char *gattServiceUuids[GATT_SERVICE_COUNT] = {
+#define GATT_SERVICE_UUID(name, uuid) uuid,
+    GATT_SERVICES(GATT_SERVICE_UUID)
+#undef GATT_SERVICE_UUID
+};
+
+constexpr GattCharacteristicInfo gattCharacteristics[GATT_CHARACTERISTIC_COUNT] = {
+#define GATT_CHARACTERISTIC_INFO(name, service, uuid, properties, size) {GATT_SERVICE_##service, uuid, properties, size},
+    GATT_CHARACTERISTICS(GATT_CHARACTERISTIC_INFO)
+#undef GATT_CHARACTERISTIC_INFO
+};
+
+// Bytes a UUID string takes on the air: 2 for the 16-bit form ("1805"), 16
+// for the full form with dashes
+constexpr size_t gattUuidSize(const char *uuid)
+{
+  size_t digits = 0;
+  for (; *uuid; uuid++)
+  {
+    digits += *uuid != '-';
+  }
+  return digits / 2;
+}
+
+// Largest value among the characteristics with any of the given properties,
+// for backends that store values themselves (GATT_WRITE: largest a central
+// can send)
+constexpr size_t gattMaxValueSize(uint8_t properties = GATT_READ | GATT_WRITE | GATT_NOTIFY)
+{
+  size_t largest = 0;
+  for (size_t i = 0; i < GATT_CHARACTERISTIC_COUNT; i++)
+  {
+    if ((gattCharacteristics[i].properties & properties) && gattCharacteristics[i].valueSize > largest)
+    {
+      largest = gattCharacteristics[i].valueSize;
+    }
+  }
+  return largest;
+}
+
+#endif
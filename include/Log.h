@@ -0,0 +1,50 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// --- Log levels (messages above LOG_LEVEL are compiled out) ---
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#ifndef LOG_BUFFER_SIZE
+#define LOG_BUFFER_SIZE 1024 // Bytes, power of two
+#endif
+#define LOG_MAX_PAYLOAD 64   // Largest record payload
+
+// Deferred binary logging: callers append a record (message ID plus raw
+// argument bytes, see Trace.h) to a lock-free single-producer /
+// single-consumer ring buffer and return; logDrain() frames the records and
+// writes them to Serial later, never more than the UART can take without
+// blocking. Records that do not fit are dropped and counted.
+//
+// Serial frame: [LOG_FRAME_SYNC][id][length][payload...][checksum]
+// where checksum is the 8-bit sum of id, length and payload. Decode with
+// python_cts_client/trace_decode.py.
+#define LOG_FRAME_SYNC 0xA5
+
+// The level check is a constant expression, so disabled calls are removed
+// by the compiler.
+#define LOG_ENABLED(level) (LOG_LEVEL >= (level))
+
+// --- Producer side ---
+void logRecord(uint8_t id, const uint8_t *payload, uint8_t length);
+// Called whenever the buffer goes from empty to non-empty (e.g. to wake the drain task)
+void logSetWakeHook(void (*hook)());
+
+// --- Consumer side ---
+// Write at most maxBytes of pending output; returns true while output remains
+bool logDrain(size_t maxBytes);
+// Blocking drain, for use before halting or resetting
+void logFlush();
+uint32_t logDroppedCount();
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef NOTIFY_POLICY_H
+#define NOTIFY_POLICY_H
+
+#include <stdint.h>
+#include "CtsSchema.h" // CTS_ADJUST_* bits
+
+#ifndef NOTIFY_ON_MINUTE_CHANGE
+#define NOTIFY_ON_MINUTE_CHANGE 1 // Notify subscribers once per wall-clock minute
+#endif
+#define NOTIFY_SIGNIFICANT_OFFSET_MS 1000 // Adjustments below this ride on the next minute notification
+
+// Decides when the Current Time characteristic is pushed to the client.
+// Nothing is sent unless a client enabled notifications (CCCD); subscribed
+// clients get one notification per manual adjustment or adjustment that
+// moved the clock by a significant amount, and otherwise at most one per
+// minute change. The Adjust Reason of a smaller adjustment is carried by
+// the next notification.
+class NotifyPolicy
+{
+public:
+  NotifyPolicy();
+
+  void setSubscribed(bool subscribed, uint64_t epochSeconds);
+  bool subscribed() const { return _subscribed; }
+
+  // The clock was set; offsetMillis is how far it moved. The reason is kept
+  // for the next notification. Returns true when this made one due
+  // immediately (CTS_ADJUST_MANUAL, or a move of at least
+  // NOTIFY_SIGNIFICANT_OFFSET_MS).
+  bool onTimeAdjusted(uint8_t adjustReason, int64_t offsetMillis);
+
+  // Call periodically; true when a notification is due now, with the Adjust
+  // Reason it should carry. The caller must send it: the state is consumed.
+  bool poll(uint64_t epochSeconds, uint8_t &adjustReason);
+
+private:
+  bool _subscribed;
+  bool _pending;
+  uint8_t _pendingReason;
+  uint64_t _lastNotifiedMinute;
+};
+
+#endif
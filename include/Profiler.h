@@ -0,0 +1,93 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+// Hot-path profiler: PROFILE_SCOPE(NAME) times the rest of the enclosing
+// block and folds the duration into NAME's entry of a static table (count,
+// min, max, total and a log2 histogram). The target reads the Cortex-M4 DWT
+// cycle counter, the native build std::chrono. With CTS_PROFILER=0 (the
+// default) PROFILE_SCOPE compiles to nothing beyond checking the name.
+#ifndef CTS_PROFILER
+#define CTS_PROFILER 0
+#endif
+#define PROFILE_REPORT_INTERVAL_MS 60000 // Summary traces while profiling
+#define PROFILE_HISTOGRAM_BUCKETS 20     // Bucket b: durations below 2^b ticks; the last is open-ended
+#define PROFILE_PACKED_BUCKETS 8         // profilePackedHistogram(): one byte each
+
+// --- Probes ---
+// P(name, label)
+#define PROFILE_PROBES(P)                                 \
+  P(UPDATE_INTERNAL_TIME, "updateInternalTime")           \
+  P(WRITE_CURRENT_TIME, "writeCurrentTime")               \
+  P(CURRENT_TIME_WRITTEN, "currentTimeWrittenHandler")    \
+  P(TRANSPORT_POLL, "transportPoll") /* Event processing only, not the wait for an event */
+
+enum ProfileProbeId : uint8_t
+{
+#define PROFILE_PROBE_ID(name, label) PROFILE_##name,
+  PROFILE_PROBES(PROFILE_PROBE_ID)
+#undef PROFILE_PROBE_ID
+  PROFILE_PROBE_COUNT
+};
+
+struct ProfileStats
+{
+  uint32_t count;
+  uint32_t minTicks;
+  uint32_t maxTicks;
+  uint64_t totalTicks;
+  uint32_t histogram[PROFILE_HISTOGRAM_BUCKETS];
+};
+
+#if CTS_PROFILER
+
+#if defined(CTS_NATIVE_SIM)
+#include <chrono>
+// Host time, not the simulation's virtual clock
+inline uint32_t profilerNow()
+{
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#define PROFILER_TICKS_PER_MICROSECOND 1000UL
+#else
+#include <Arduino.h> // CMSIS core registers
+inline uint32_t profilerNow()
+{
+  return DWT->CYCCNT;
+}
+#define PROFILER_TICKS_PER_MICROSECOND (SystemCoreClock / 1000000UL)
+#endif
+
+// Starts the cycle counter (no-op natively)
+void profilerBegin();
+void profileRecord(ProfileProbeId probe, uint32_t ticks);
+const ProfileStats &profileStats(ProfileProbeId probe);
+const char *profileProbeLabel(ProfileProbeId probe);
+uint32_t profileTicksToNanos(uint64_t ticks);
+// Compact form for the diagnostics characteristic (see CtsDiagnostics in
+// CtsSchema.h): the histogram as eight one-byte shares in base-4
+// microsecond buckets, and the maximum in microseconds (saturating)
+uint64_t profilePackedHistogram(ProfileProbeId probe);
+uint16_t profileMaxMicros(ProfileProbeId probe);
+void profileReset();
+// One summary trace per probe that ran
+void profileReport();
+
+class ProfileScope
+{
+public:
+  explicit ProfileScope(ProfileProbeId probe) : _probe(probe), _start(profilerNow()) {}
+  ~ProfileScope() { profileRecord(_probe, profilerNow() - _start); }
+
+private:
+  ProfileProbeId _probe;
+  uint32_t _start;
+};
+
+#define PROFILE_SCOPE(name) ProfileScope profileScope_##name(PROFILE_##name)
+#else
+#define PROFILE_SCOPE(name) (void)PROFILE_##name
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+// Sequence lock for a small value with a single writer, in its latch form:
+// the value is kept twice and the sequence says which copy is stable. The
+// writer never waits; it moves readers to one copy, rewrites the other, then
+// swaps them over and rewrites the first. A reader copies whichever one the
+// sequence points at and retries only if the sequence moved meanwhile, so
+// it never sees a mix of old and new fields and never holds up the writer.
+template <typename T>
+class SeqLock
+{
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock values are copied bytewise");
+
+public:
+  SeqLock() : _sequence(0), _values() {}
+
+  // Writer side: call from one context only
+  void write(const T &value)
+  {
+    uint32_t sequence = _sequence.load(std::memory_order_relaxed); // Even between writes
+    _sequence.store(sequence + 1, std::memory_order_relaxed);      // Odd: readers use _values[1]
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&_values[0], &value, sizeof(T));
+    _sequence.store(sequence + 2, std::memory_order_release);      // Even: readers use _values[0]
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&_values[1], &value, sizeof(T));
+  }
+
+  // Reader side: any context. One that preempts the writer (a higher
+  // priority thread or an ISR on the same core) reads the copy the writer is
+  // not touching and never waits. Only a reader the writer runs against - a
+  // lower-priority context on the same core it preempted, or another core -
+  // can see the sequence move and retry, and the writer finishes regardless.
+  T read() const
+  {
+    T value;
+    uint32_t before;
+    uint32_t after;
+    do
+    {
+      before = _sequence.load(std::memory_order_acquire);
+      // Races with the writer by design; a torn copy is discarded below
+      memcpy(&value, &_values[before & 1], sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = _sequence.load(std::memory_order_relaxed);
+    } while (before != after);
+    return value;
+  }
+
+  // Changes on every write; lets a reader skip work when nothing is new
+  uint32_t sequence() const { return _sequence.load(std::memory_order_acquire); }
+
+private:
+  std::atomic<uint32_t> _sequence;
+  T _values[2];
+};
+
+#endif
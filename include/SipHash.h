@@ -0,0 +1,77 @@
+#ifndef SIP_HASH_H
+#define SIP_HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "CtsCodec.h"
+
+// SipHash-2-4 (Aumasson & Bernstein): a keyed 64-bit MAC cheap enough for
+// short messages on a Cortex-M4, used to authenticate gateway time
+// broadcasts. Header-only and constexpr so the reference vector is checked
+// at compile time.
+
+#define SIP_HASH_KEY_SIZE 16
+
+namespace SipHash
+{
+  constexpr uint64_t rotl(uint64_t x, int b)
+  {
+    return (x << b) | (x >> (64 - b));
+  }
+
+  struct State
+  {
+    uint64_t v0, v1, v2, v3;
+
+    constexpr void round()
+    {
+      v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+      v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+      v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+      v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+    }
+
+    constexpr void compress(uint64_t m)
+    {
+      v3 ^= m;
+      round();
+      round();
+      v0 ^= m;
+    }
+  };
+}
+
+constexpr uint64_t sipHash24(const uint8_t key[SIP_HASH_KEY_SIZE], const uint8_t *data, size_t length)
+{
+  uint64_t k0 = ctsLoad<uint64_t>(key);
+  uint64_t k1 = ctsLoad<uint64_t>(key + 8);
+  SipHash::State s = {k0 ^ 0x736f6d6570736575ULL, k1 ^ 0x646f72616e646f6dULL,
+                      k0 ^ 0x6c7967656e657261ULL, k1 ^ 0x7465646279746573ULL};
+  size_t end = length - length % 8;
+  for (size_t i = 0; i < end; i += 8)
+  {
+    s.compress(ctsLoad<uint64_t>(data + i));
+  }
+  // Last block: the remaining bytes, with the message length in the top byte
+  uint64_t last = (uint64_t)length << 56;
+  for (size_t i = end; i < length; i++)
+  {
+    last |= (uint64_t)data[i] << (8 * (i - end));
+  }
+  s.compress(last);
+  s.v2 ^= 0xFF;
+  s.round();
+  s.round();
+  s.round();
+  s.round();
+  return s.v0 ^ s.v1 ^ s.v2 ^ s.v3;
+}
+
+// Reference vector from the SipHash paper: key 00..0F, message 00..0E
+namespace SipHashCheck
+{
+  constexpr uint8_t kKey[SIP_HASH_KEY_SIZE] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+  static_assert(sipHash24(kKey, kKey, 15) == 0xa129ca6149be45e5ULL, "SipHash-2-4 reference vector");
+}
+
+#endif
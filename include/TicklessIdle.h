@@ -0,0 +1,30 @@
+#ifndef TICKLESS_IDLE_H
+#define TICKLESS_IDLE_H
+
+#include <TaskSchedulerDeclarations.h>
+
+// Drives a TaskScheduler instance without a busy BLE poll task.
+// After loop() has run whatever is due, the CPU waits inside transportPoll(timeout)
+// until the earliest watched task deadline or until the radio raises an
+// event, whichever comes first. On the mbed-based cores that wait blocks on
+// an RTOS event flag, which lets the idle thread enter low-power sleep.
+class TicklessIdle
+{
+public:
+  TicklessIdle(Scheduler &scheduler, Task *const *tasks, uint8_t taskCount, unsigned long maxSleepMillis);
+
+  // Milliseconds until the next enabled task is due (capped at maxSleepMillis)
+  unsigned long nextDeadline();
+
+  // Second half of a loop() iteration, after the scheduler ran the due
+  // tasks: sleep until the next deadline or a radio event
+  void sleep();
+
+private:
+  Scheduler &_scheduler;
+  Task *const *_tasks;
+  uint8_t _taskCount;
+  unsigned long _maxSleepMillis;
+};
+
+#endif
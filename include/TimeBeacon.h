@@ -0,0 +1,43 @@
+#ifndef TIME_BEACON_H
+#define TIME_BEACON_H
+
+#include <stdint.h>
+#include "CtsCodec.h"
+
+#define TIME_BEACON_VERSION 1
+#define TIME_BEACON_COMPANY_ID 0xFFFF // Bluetooth SIG "internal testing" ID; use an assigned one in products
+#ifndef TIME_BEACON_REFRESH_MS
+#define TIME_BEACON_REFRESH_MS 10000 // The stamp on air is at most this old
+#endif
+#define TIME_BEACON_NEVER_SYNCED 0xFFFFFFFF // secondsSinceSync before the first sync
+#define TIME_BEACON_ERROR_UNKNOWN 0xFFFF    // errorEstimateMs without two syncs to go by
+
+// Advertising manufacturer data describing the watch's clock (layout in
+// CtsSchema.h). A host compares the stamp with its own time and reads the
+// error estimate to decide from a passive scan whether a sync is due,
+// instead of connecting just to find out.
+class TimeBeacon
+{
+public:
+  TimeBeacon();
+
+  // sinceSyncTicks / lastSpanTicks: ticks since the last sync and between
+  // the last two (0 if there was no earlier one); lastOffsetTicks: the
+  // correction the last sync applied
+  void update(uint64_t epochSeconds, bool synced, uint64_t sinceSyncTicks,
+              uint64_t lastSpanTicks, int64_t lastOffsetTicks, int32_t driftPpb);
+
+  // Manufacturer data: company ID (little-endian), then the beacon
+  const uint8_t *data() const { return _data; }
+  int length() const { return sizeof(_data); }
+
+  // The last sync's offset, spread over the interval it accumulated in, as
+  // a rate; projected over the time since. Conservative, since that sync
+  // also refined the drift correction.
+  static uint16_t errorEstimateMs(uint64_t sinceSyncTicks, uint64_t lastSpanTicks, int64_t lastOffsetTicks);
+
+private:
+  uint8_t _data[2 + CtsTimeBeacon::WIRE_SIZE];
+};
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef TIME_STATE_H
+#define TIME_STATE_H
+
+#include <stdint.h>
+#include "EpochClock.h"
+#include "SeqLock.h"
+
+// Everything the server serializes about its time, published as one unit by
+// the context that owns the system clock. A reader takes a whole snapshot,
+// so it never pairs the new time with the old sync record (or half of a
+// DateTime), and advances its own copy of the clock to the present instead
+// of updating the shared one.
+struct TimeSnapshot
+{
+  EpochClock clock;           // Copy of the system clock as of its last update
+  uint64_t lastSyncRawTicks;  // clock.rawTicks() when the time was last set
+  uint64_t lastSyncSpanTicks; // Raw ticks between the last two syncs (0 until there were two)
+  int64_t lastOffsetTicks;    // Correction applied at the last sync
+  bool synced;                // The time has been set since boot
+
+  uint64_t ticksSinceSync() const { return clock.rawTicks() - lastSyncRawTicks; }
+};
+
+// Single writer (the scheduler task that updates the clock), any number of
+// readers that never block it
+typedef SeqLock<TimeSnapshot> TimeState;
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+
+// --- Timebase backends (select with -DCTS_TIMEBASE=...) ---
+#define TIMEBASE_MILLIS 0    // millis() polling, works on any core
+#define TIMEBASE_NRF52_RTC 1 // nRF52840 RTC2 counter on the 32.768 kHz LFCLK
+
+#ifndef CTS_TIMEBASE
+#if defined(NRF52840_XXAA) && !defined(CTS_NATIVE_SIM)
+#define CTS_TIMEBASE TIMEBASE_NRF52_RTC
+#else
+#define CTS_TIMEBASE TIMEBASE_MILLIS
+#endif
+#endif
+
+#if CTS_TIMEBASE == TIMEBASE_NRF52_RTC
+#define TIMEBASE_TICKS_PER_SECOND 32768UL
+// The extended counter wraps every 36.4 hours; refreshing hourly keeps
+// EpochClock::update() deltas unambiguous while the CPU sleeps otherwise
+#define TIMEBASE_UPDATE_INTERVAL_MS 3600000UL
+#elif CTS_TIMEBASE == TIMEBASE_MILLIS
+#define TIMEBASE_TICKS_PER_SECOND 1000UL
+#define TIMEBASE_UPDATE_INTERVAL_MS 1000UL
+#else
+#error "Unknown CTS_TIMEBASE"
+#endif
+
+// Start the backend (idempotent)
+void timebaseBegin();
+
+// Free-running tick counter at TIMEBASE_TICKS_PER_SECOND. Wraps at 2^32;
+// callers work with unsigned deltas and must sample it at least once per wrap.
+uint32_t timebaseNow();
+
+#endif
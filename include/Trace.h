@@ -0,0 +1,177 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include "Log.h"
+#include "BleAddress.h"
+#include "EpochClock.h"
+#include "TraceMessages.h"
+
+// Binary tracing: TRACE(NAME, args...) queues message TRACE_NAME with its
+// arguments copied raw into the log ring; no text is formatted on the MCU.
+// The argument types are checked against the layout in TraceMessages.h at
+// compile time, so firmware and host decoder cannot silently disagree.
+
+enum TraceId : uint8_t
+{
+#define TRACE_ID(id, name, level, layout, format) TRACE_##name = id,
+  TRACE_MESSAGES(TRACE_ID)
+#undef TRACE_ID
+};
+
+#define TRACE_ID_VALUE(id, name, level, layout, format) id,
+constexpr uint8_t traceIds[] = {TRACE_MESSAGES(TRACE_ID_VALUE)};
+#undef TRACE_ID_VALUE
+
+constexpr bool traceIdsDense()
+{
+  for (size_t i = 0; i < sizeof(traceIds); i++)
+  {
+    if (traceIds[i] != i + 1)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+static_assert(traceIdsDense(), "TraceMessages.h ids must run 1, 2, 3... in table order");
+
+#define TRACE_LEVEL_ENUM(id, name, level, layout, format) TRACE_LEVEL_##name = level,
+enum TraceLevel
+{
+  TRACE_MESSAGES(TRACE_LEVEL_ENUM)
+};
+#undef TRACE_LEVEL_ENUM
+
+#define TRACE_LAYOUT_STRING(id, name, level, layout, format) static constexpr const char *name = layout;
+struct TraceLayout
+{
+  TRACE_MESSAGES(TRACE_LAYOUT_STRING)
+};
+#undef TRACE_LAYOUT_STRING
+
+// Length-prefixed arguments ('s' and 'x')
+struct TraceString
+{
+  const char *text;
+};
+
+struct TraceBytes
+{
+  const uint8_t *data;
+  uint8_t length;
+};
+
+static_assert(sizeof(DateTime) == 8, "DateTime is traced as 8 packed bytes");
+static_assert(sizeof(BleAddress) == BLE_ADDRESS_SIZE, "BleAddress is traced as its 6 bytes");
+
+// --- Layout codes per argument type ---
+template <typename T>
+constexpr char traceCode()
+{
+  static_assert(std::is_integral<T>::value, "unsupported trace argument type");
+  return sizeof(T) == 1 ? (std::is_signed<T>::value ? 'b' : 'B')
+       : sizeof(T) == 2 ? (std::is_signed<T>::value ? 'h' : 'H')
+       : sizeof(T) == 4 ? (std::is_signed<T>::value ? 'i' : 'I')
+                        : (std::is_signed<T>::value ? 'q' : 'Q');
+}
+template <>
+constexpr char traceCode<DateTime>() { return 'T'; }
+template <>
+constexpr char traceCode<BleAddress>() { return 'a'; }
+template <>
+constexpr char traceCode<TraceString>() { return 's'; }
+template <>
+constexpr char traceCode<TraceBytes>() { return 'x'; }
+
+// Type list of a TRACE() call, compared code by code with the message layout
+template <typename... Args>
+struct TraceArgs;
+
+template <>
+struct TraceArgs<>
+{
+  static constexpr bool matches(const char *layout) { return *layout == '\0'; }
+};
+
+template <typename First, typename... Rest>
+struct TraceArgs<First, Rest...>
+{
+  static constexpr bool matches(const char *layout)
+  {
+    return *layout == traceCode<First>() && TraceArgs<Rest...>::matches(layout + 1);
+  }
+};
+
+// Only used inside decltype: turns call arguments into their TraceArgs type
+template <typename... Args>
+TraceArgs<typename std::decay<Args>::type...> traceArgs(const Args &...);
+
+// --- Argument packing ---
+template <typename T>
+inline uint8_t tracePack(uint8_t *out, uint8_t offset, const T &value)
+{
+  if (offset + sizeof(T) > LOG_MAX_PAYLOAD)
+  {
+    return offset;
+  }
+  memcpy(out + offset, &value, sizeof(T)); // Both ends are little-endian
+  return offset + sizeof(T);
+}
+
+inline uint8_t tracePackBlob(uint8_t *out, uint8_t offset, const void *data, size_t length)
+{
+  if (offset >= LOG_MAX_PAYLOAD)
+  {
+    return offset;
+  }
+  size_t room = LOG_MAX_PAYLOAD - offset - 1;
+  if (length > room)
+  {
+    length = room;
+  }
+  out[offset] = length;
+  memcpy(out + offset + 1, data, length);
+  return offset + 1 + length;
+}
+
+inline uint8_t tracePack(uint8_t *out, uint8_t offset, const TraceString &value)
+{
+  return tracePackBlob(out, offset, value.text, strlen(value.text));
+}
+
+inline uint8_t tracePack(uint8_t *out, uint8_t offset, const TraceBytes &value)
+{
+  return tracePackBlob(out, offset, value.data, value.length);
+}
+
+// Messages without fields: no payload buffer to leave uninitialized
+inline void traceEmit(uint8_t id)
+{
+  logRecord(id, NULL, 0);
+}
+
+template <typename... Args>
+inline void traceEmit(uint8_t id, const Args &...args)
+{
+  uint8_t payload[LOG_MAX_PAYLOAD];
+  uint8_t length = 0;
+  int expand[] = {0, (length = tracePack(payload, length, args), 0)...};
+  (void)expand;
+  logRecord(id, payload, length);
+}
+
+#define TRACE(name, ...)                                                             \
+  do                                                                                 \
+  {                                                                                  \
+    static_assert(decltype(traceArgs(__VA_ARGS__))::matches(TraceLayout::name),      \
+                  "TRACE(" #name ") arguments do not match its TraceMessages.h layout"); \
+    if (LOG_ENABLED(TRACE_LEVEL_##name))                                             \
+    {                                                                                \
+      traceEmit(TRACE_##name, ##__VA_ARGS__);                                        \
+    }                                                                                \
+  } while (0)
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef TRACE_MESSAGES_H
+#define TRACE_MESSAGES_H
+
+// Binary trace message table, shared with python_cts_client/trace_decode.py
+// (which parses this file to build its string table - keep one entry per line).
+//
+// X(id, name, level, layout, format)
+//   id      message number on the wire, dense from 1 in table order (checked in
+//           Trace.h); new messages go at the end so shipped ids keep their meaning
+//   layout  argument encoding, one code per argument:
+//             b/B h/H i/I q/Q  signed/unsigned 8/16/32/64-bit integer (little-endian)
+//             T                DateTime (year u16, month, day, hour, minute, second, dayOfWeek)
+//             a                BLE address, 6 bytes little-endian (rendered "aa:bb:cc:dd:ee:ff")
+//             s                string, u8 length + bytes
+//             x                byte blob, u8 length + bytes (rendered as "0xNN, ...")
+//   format  printf-style text the host renders the arguments with
+#define TRACE_MESSAGES(X)                                                                                    \
+  X(1, BOOT, LOG_LEVEL_INFO, "s", "Starting BLE CTS Server ver 1 : %s")                                      \
+  X(2, BLE_BEGIN_FAILED, LOG_LEVEL_ERROR, "", "Starting BLE failed!")                                        \
+  X(3, ADVERTISING_STARTED, LOG_LEVEL_INFO, "", "Advertising started")                                       \
+  X(4, MAC_ADDRESS, LOG_LEVEL_INFO, "s", "MAC Address: %s")                                                  \
+  X(5, ADVERTISING_FAILED, LOG_LEVEL_ERROR, "", "Advertising failed to start!")                              \
+  X(6, SETUP_COMPLETE, LOG_LEVEL_INFO, "", "Setup complete. Running tasks...")                               \
+  X(7, SYSTEM_TIME, LOG_LEVEL_INFO, "T", "System Time: %04d-%02d-%02d %02d:%02d:%02d DOW:%d")                \
+  X(8, CURRENT_TIME_WRITE_FAILED, LOG_LEVEL_ERROR, "", "Error writing Current Time characteristic!")         \
+  X(9, INITIAL_CHARACTERISTICS_SENT, LOG_LEVEL_INFO, "", "Initial characteristics sent.")                    \
+  X(10, ADVERTISING_RESTARTED, LOG_LEVEL_INFO, "", "Restarted advertising.")                                 \
+  X(11, ADVERTISING_RESTART_FAILED, LOG_LEVEL_ERROR, "", "Failed to restart advertising!")                   \
+  X(12, RAW_DATA, LOG_LEVEL_DEBUG, "x", "  Raw Data Received: [%s]")                                         \
+  X(13, TIME_UPDATED, LOG_LEVEL_INFO, "", "Internal time updated by client:")                                \
+  X(14, NEW_TIME, LOG_LEVEL_INFO, "TB", "  New Time: %04d-%02d-%02d %02d:%02d:%02d DOW:%d +%d/256 s")        \
+  X(15, SYNC_OFFSET, LOG_LEVEL_INFO, "qi", "  Offset: %d ms, drift correction: %d ppb")                       \
+  X(16, CONNECTION_ESTABLISHED, LOG_LEVEL_INFO, "", "Connection established.")                               \
+  X(17, ALREADY_CONNECTED, LOG_LEVEL_INFO, "", "Already connected, ignoring duplicate connect event.")       \
+  X(18, CONNECTION_TERMINATED, LOG_LEVEL_INFO, "", "Connection terminated.")                                 \
+  X(19, ADVERTISING_STOPPED, LOG_LEVEL_INFO, "", "Stopped advertising.")                                     \
+  X(20, NOT_CONNECTED, LOG_LEVEL_INFO, "", "Ignoring disconnect event, was not connected.")               \
+  X(21, WRITE_REJECTED, LOG_LEVEL_WARN, "BHx", "Rejected Current Time write: reason %d, %d more suppressed [%s]") \
+  X(22, CENTRALS_CONNECTED, LOG_LEVEL_INFO, "BB", "Centrals connected: %d/%d")                                 \
+  X(23, ADVERTISING_PHASE, LOG_LEVEL_INFO, "BHI", "Advertising phase %d: interval %d x 0.625ms (start #%d)") \
+  X(24, TIME_WRITTEN_BY, LOG_LEVEL_INFO, "a", "Current Time characteristic written by: %s")                   \
+  X(25, CONNECTED, LOG_LEVEL_INFO, "a", "Connected event for: %s")                                            \
+  X(26, DISCONNECTED, LOG_LEVEL_INFO, "a", "Disconnected event for: %s")                                      \
+  X(27, CONNECTION_TABLE_FULL, LOG_LEVEL_WARN, "a", "No free connection slot, disconnecting: %s")             \
+  X(28, CONNECTION_PROFILE, LOG_LEVEL_INFO, "aBHHB", "Connection %s: profile %d (interval <= %d x 1.25ms, latency %d), sent %d") \
+  X(29, GATEWAY_TIME_ACCEPTED, LOG_LEVEL_INFO, "aI", "Gateway time from %s (sequence %u)")                    \
+  X(30, GATEWAY_TIME_REJECTED, LOG_LEVEL_WARN, "aB", "Rejected gateway broadcast from %s: reason %d")          \
+  X(31, PROFILE_SUMMARY, LOG_LEVEL_INFO, "sIIII", "Profile %s: %u calls, min %u ns, mean %u ns, max %u ns")
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "BleAddress.h"
+#include "GattTable.h"
+
+// The BLE operations the server needs, so its logic does not depend on a
+// particular stack: a characteristic store (GattTable.h), event dispatch,
+// advertising/scanning and link control.
+
+// --- Transport backends (select with -DCTS_TRANSPORT=...) ---
+#define TRANSPORT_ARDUINO_BLE 0 // ArduinoBLE: the radio, or lib/NativeSim's fake of it
+#define TRANSPORT_LOOPBACK 1    // In memory, driven by direct calls; for host benchmarks
+
+#ifndef CTS_TRANSPORT
+#define CTS_TRANSPORT TRANSPORT_ARDUINO_BLE
+#endif
+
+// BLE thread: run ArduinoBLE on its own mbed OS thread, which sleeps until
+// the controller has an event, instead of polling it from the task loop.
+// Stack events reach the application through a lock-free queue that
+// transportPoll() drains, so the radio is serviced however long a task
+// runs, and the loop sleeps on the queue. Needs an mbed core.
+#ifndef CTS_BLE_THREAD
+#define CTS_BLE_THREAD 0
+#endif
+#if CTS_BLE_THREAD && (CTS_TRANSPORT != TRANSPORT_ARDUINO_BLE || !defined(ARDUINO_ARCH_MBED))
+#error "CTS_BLE_THREAD needs the ArduinoBLE transport on an mbed core"
+#endif
+
+#if CTS_TRANSPORT == TRANSPORT_ARDUINO_BLE
+#include <ArduinoBLE.h>
+#elif CTS_TRANSPORT == TRANSPORT_LOOPBACK
+#include <Arduino.h>
+#else
+#error "Unknown CTS_TRANSPORT"
+#endif
+
+// --- Advertising packet budget ---
+// A legacy advertising packet carries 31 bytes of AD structures, each with a
+// 2-byte header (length, type). The flags take 3; the local name goes in the
+// scan response.
+#define TRANSPORT_ADVERTISING_PACKET_SIZE 31
+#define TRANSPORT_AD_FLAGS_SIZE 3
+// Manufacturer data, company ID included, of an advertising packet that
+// holds nothing but the flags: 31 - 3 - 2 = 26 (24 after the company ID)
+#define TRANSPORT_MANUFACTURER_DATA_SIZE (TRANSPORT_ADVERTISING_PACKET_SIZE - TRANSPORT_AD_FLAGS_SIZE - 2)
+
+// What is left of that once the advertised service UUID (the first of
+// GATT_SERVICES) is in the packet too; the stack drops manufacturer data
+// that does not fit
+constexpr size_t transportAdvertisedManufacturerDataSize()
+{
+  return TRANSPORT_MANUFACTURER_DATA_SIZE - (2 + gattUuidSize(gattServiceUuids[0]));
+}
+
+// A remote device (connected central or scan report), by value: the backend
+// fills it in once per event and nothing above the transport allocates for
+// it or holds on to stack objects
+class TransportPeer
+{
+public:
+  TransportPeer();
+  explicit TransportPeer(const BleAddress &address, const uint8_t *manufacturerData = NULL, int manufacturerDataLength = 0);
+
+  const BleAddress &address() const { return _address; }
+
+  bool hasManufacturerData() const { return _manufacturerDataLength > 0; }
+  int manufacturerDataLength() const { return _manufacturerDataLength; }
+  int manufacturerData(uint8_t value[], int length) const;
+
+  operator bool() const { return !_address.isNull(); }
+  bool operator==(const TransportPeer &rhs) const { return _address == rhs._address; }
+  bool operator!=(const TransportPeer &rhs) const { return !(*this == rhs); }
+
+private:
+  BleAddress _address;
+  uint8_t _manufacturerData[TRANSPORT_MANUFACTURER_DATA_SIZE];
+  uint8_t _manufacturerDataLength;
+};
+
+enum TransportPeerEvent : uint8_t
+{
+  TRANSPORT_CONNECTED = 0,
+  TRANSPORT_DISCONNECTED,
+  TRANSPORT_DISCOVERED, // Scan report while scanning
+  TRANSPORT_PEER_EVENT_COUNT
+};
+
+enum TransportCharacteristicEvent : uint8_t
+{
+  TRANSPORT_WRITTEN = 0,   // A peer wrote the value; read it with transportValue()
+  TRANSPORT_READ,          // A peer is about to read the value: refresh it now. Runs in the
+                           // stack's context (with CTS_BLE_THREAD usually the BLE thread), so
+                           // it may only use state that is safe to read from there
+  TRANSPORT_SUBSCRIBED,
+  TRANSPORT_UNSUBSCRIBED,
+  TRANSPORT_CHARACTERISTIC_EVENT_COUNT
+};
+
+typedef void (*TransportPeerHandler)(const TransportPeer &peer);
+typedef void (*TransportCharacteristicHandler)(const TransportPeer &peer, GattCharacteristicId characteristic);
+
+// --- Lifecycle ---
+// Starts the stack and registers every service in GattTable.h
+bool transportBegin(const char *deviceName);
+// Dispatches pending events, waiting up to timeoutMillis for one (0 = don't wait)
+void transportPoll(unsigned long timeoutMillis);
+String transportAddress();
+#if CTS_BLE_THREAD
+// Events lost because the application fell a whole queue behind
+uint32_t transportDroppedEvents();
+#endif
+
+// --- Characteristic store ---
+// Sets the value and notifies subscribed peers: only for notifications the
+// application decided to send
+bool transportWriteValue(GattCharacteristicId characteristic, const uint8_t *data, size_t length);
+// Sets the value without notifying anyone; the next read returns it. For
+// read hooks and for populating values
+bool transportSetValue(GattCharacteristicId characteristic, const uint8_t *data, size_t length);
+// The value a peer wrote; only valid inside that TRANSPORT_WRITTEN handler
+const uint8_t *transportValue(GattCharacteristicId characteristic, size_t &length);
+
+// --- Event dispatch ---
+void transportSetPeerHandler(TransportPeerEvent event, TransportPeerHandler handler);
+void transportSetCharacteristicHandler(GattCharacteristicId characteristic, TransportCharacteristicEvent event,
+                                       TransportCharacteristicHandler handler);
+
+// --- Advertising and scanning ---
+void transportSetAdvertisingInterval(uint16_t interval); // 0.625ms units, used by the next advertise
+void transportSetManufacturerData(const uint8_t *data, int length);
+bool transportAdvertise(); // Builds the packet from the data set so far
+void transportStopAdvertise();
+bool transportScan(bool withDuplicates);
+void transportStopScan();
+
+// --- Link control ---
+bool transportDisconnect(const BleAddress &peer);
+// Parameters the stack asks for when a link opens (1.25ms / 10ms units)
+void transportSetPreferredConnection(uint16_t minInterval, uint16_t maxInterval, uint16_t supervisionTimeout);
+// Asks to change an open link's parameters; false if the request was not sent
+bool transportUpdateConnection(const BleAddress &peer, uint16_t minInterval, uint16_t maxInterval,
+                               uint16_t latency, uint16_t supervisionTimeout);
+
+#if CTS_TRANSPORT == TRANSPORT_LOOPBACK
+// --- Loopback driver ---
+// Plays the remote side. Events are dispatched synchronously, before the
+// call returns; nothing is ever left for transportPoll().
+#define LOOPBACK_MAX_PEERS 8
+void loopbackConnect(const TransportPeer &peer);
+void loopbackDisconnect(const TransportPeer &peer);
+bool loopbackWrite(const TransportPeer &peer, GattCharacteristicId characteristic, const uint8_t *data, size_t length);
+// Runs the read handler, then copies the value; -1 if not readable
+int loopbackRead(const TransportPeer &peer, GattCharacteristicId characteristic, uint8_t *data, size_t size);
+bool loopbackSubscribe(const TransportPeer &peer, GattCharacteristicId characteristic, bool enabled);
+// A scan report for peer (with its manufacturer data), if scanning
+void loopbackAdvertisement(const TransportPeer &peer);
+uint32_t loopbackNotificationCount(GattCharacteristicId characteristic);
+bool loopbackAdvertising();
+#endif
+
+#endif
@@ -0,0 +1,234 @@
+#include <stdarg.h>
+#include "Arduino.h"
+#include "NativeSim.h"
+
+HardwareSerial Serial;
+
+static uint64_t simMicros = 0; // Reference time
+static int32_t driftPpm = 0;
+static bool serialOutput = false;
+static int serialWriteSpace = 64;
+static uint8_t pinValues[64];
+
+// --- Virtual clock ---
+
+uint64_t simNowMillis()
+{
+  return simMicros / 1000;
+}
+
+void simAdvanceMillis(uint32_t ms)
+{
+  simMicros += (uint64_t)ms * 1000;
+}
+
+void simSetClockDriftPpm(int32_t ppm)
+{
+  driftPpm = ppm;
+}
+
+// Time as seen by the watch's oscillator
+static uint64_t localMicros()
+{
+  return simMicros + (int64_t)simMicros * driftPpm / 1000000;
+}
+
+// The host unsigned long is 64-bit, so millis() never wraps during a replay
+unsigned long millis()
+{
+  return (unsigned long)(localMicros() / 1000);
+}
+
+unsigned long micros()
+{
+  return (unsigned long)localMicros();
+}
+
+void delay(unsigned long ms)
+{
+  simMicros += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  simMicros += us;
+}
+
+void yield() {}
+void noInterrupts() {}
+void interrupts() {}
+
+// --- GPIO ---
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  if (pin < sizeof(pinValues))
+  {
+    pinValues[pin] = value;
+  }
+}
+
+int digitalRead(uint8_t pin)
+{
+  return pin < sizeof(pinValues) ? pinValues[pin] : LOW;
+}
+
+// --- String ---
+
+String::String(const char *value)
+{
+  _length = strlen(value);
+  _buffer = (char *)malloc(_length + 1);
+  memcpy(_buffer, value, _length + 1);
+}
+
+String::String(const String &other) : String(other.c_str())
+{
+}
+
+String::~String()
+{
+  free(_buffer);
+}
+
+String &String::operator=(const String &other)
+{
+  if (this != &other)
+  {
+    free(_buffer);
+    _length = other._length;
+    _buffer = (char *)malloc(_length + 1);
+    memcpy(_buffer, other._buffer, _length + 1);
+  }
+  return *this;
+}
+
+bool String::operator==(const String &other) const
+{
+  return _length == other._length && memcmp(_buffer, other._buffer, _length) == 0;
+}
+
+// --- Print ---
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--)
+  {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::printNumber(unsigned long value, int base)
+{
+  char buffer[8 * sizeof(long) + 1];
+  char *str = &buffer[sizeof(buffer) - 1];
+  *str = '\0';
+  if (base < 2)
+  {
+    base = 10;
+  }
+  do
+  {
+    unsigned long digit = value % base;
+    value /= base;
+    *--str = digit < 10 ? '0' + digit : 'A' + digit - 10;
+  } while (value);
+  return write(str);
+}
+
+size_t Print::print(const char *str) { return write(str); }
+size_t Print::print(const String &str) { return write(str.c_str()); }
+size_t Print::print(char value) { return write((uint8_t)value); }
+size_t Print::print(unsigned char value, int base) { return printNumber(value, base); }
+size_t Print::print(unsigned int value, int base) { return printNumber(value, base); }
+size_t Print::print(unsigned long value, int base) { return printNumber(value, base); }
+size_t Print::print(int value, int base) { return print((long)value, base); }
+
+size_t Print::print(long value, int base)
+{
+  if (base == DEC && value < 0)
+  {
+    return write('-') + printNumber(-(unsigned long)value, base);
+  }
+  return printNumber((unsigned long)value, base);
+}
+
+size_t Print::print(double value, int digits)
+{
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+  return write(buffer);
+}
+
+size_t Print::println() { return write("\r\n"); }
+size_t Print::println(const char *str) { return print(str) + println(); }
+size_t Print::println(const String &str) { return print(str) + println(); }
+size_t Print::println(char value) { return print(value) + println(); }
+size_t Print::println(unsigned char value, int base) { return print(value, base) + println(); }
+size_t Print::println(int value, int base) { return print(value, base) + println(); }
+size_t Print::println(unsigned int value, int base) { return print(value, base) + println(); }
+size_t Print::println(long value, int base) { return print(value, base) + println(); }
+size_t Print::println(unsigned long value, int base) { return print(value, base) + println(); }
+size_t Print::println(double value, int digits) { return print(value, digits) + println(); }
+
+size_t Print::printf(const char *format, ...)
+{
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (length < 0)
+  {
+    return 0;
+  }
+  return write((const uint8_t *)buffer, length < (int)sizeof(buffer) ? length : sizeof(buffer) - 1);
+}
+
+// --- Serial ---
+
+void simSetSerialOutput(bool enabled)
+{
+  serialOutput = enabled;
+}
+
+void simSetSerialWriteSpace(int bytes)
+{
+  serialWriteSpace = bytes;
+}
+
+void HardwareSerial::begin(unsigned long baud)
+{
+  (void)baud;
+}
+
+int HardwareSerial::availableForWrite()
+{
+  return serialWriteSpace;
+}
+
+size_t HardwareSerial::write(uint8_t value)
+{
+  if (serialOutput)
+  {
+    fputc(value, stdout);
+  }
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    write(buffer[i]);
+  }
+  return size;
+}
@@ -0,0 +1,108 @@
+#ifndef NATIVE_SIM_ARDUINO_H
+#define NATIVE_SIM_ARDUINO_H
+
+// Minimal Arduino core for the native build. Time comes from the virtual
+// clock in NativeSim.h, so delay() returns immediately after advancing it.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define LED_BUILTIN 13
+
+#define DEC 10
+#define HEX 16
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+void noInterrupts();
+void interrupts();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+// Owning string with the subset of the Arduino String API the sketch uses
+class String
+{
+public:
+  String(const char *value = "");
+  String(const String &other);
+  ~String();
+  String &operator=(const String &other);
+
+  const char *c_str() const { return _buffer; }
+  unsigned int length() const { return _length; }
+  char operator[](unsigned int index) const { return index < _length ? _buffer[index] : '\0'; }
+  bool operator==(const String &other) const;
+  bool operator!=(const String &other) const { return !(*this == other); }
+
+private:
+  char *_buffer;
+  unsigned int _length;
+};
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t value) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+
+  size_t print(const char *str);
+  size_t print(const String &str);
+  size_t print(char value);
+  size_t print(unsigned char value, int base = DEC);
+  size_t print(int value, int base = DEC);
+  size_t print(unsigned int value, int base = DEC);
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(double value, int digits = 2);
+
+  size_t println();
+  size_t println(const char *str);
+  size_t println(const String &str);
+  size_t println(char value);
+  size_t println(unsigned char value, int base = DEC);
+  size_t println(int value, int base = DEC);
+  size_t println(unsigned int value, int base = DEC);
+  size_t println(long value, int base = DEC);
+  size_t println(unsigned long value, int base = DEC);
+  size_t println(double value, int digits = 2);
+
+  size_t printf(const char *format, ...);
+
+private:
+  size_t printNumber(unsigned long value, int base);
+};
+
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long baud);
+  void end() {}
+  int availableForWrite();
+  void flush() {}
+  operator bool() const { return true; }
+
+  using Print::write;
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,607 @@
+#include <strings.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "ArduinoBLE.h"
+#include "NativeSim.h"
+#include "utility/ATT.h"
+#include "utility/HCI.h"
+#include "utility/HCITransport.h"
+
+BLELocalDevice BLE;
+ATTClass ATT;
+HCIClass HCI;
+
+class SimHCITransport : public HCITransportInterface
+{
+public:
+  void wait(unsigned long timeout) override;
+};
+static SimHCITransport simHCITransport;
+HCITransportInterface &HCITransport = simHCITransport;
+
+struct SimCharacteristicState
+{
+  const char *uuid;
+  uint8_t properties;
+  int valueSize;
+  uint8_t value[512];
+  int valueLength;
+  std::vector<std::string> subscribers; // Addresses of centrals with notifications enabled
+  uint32_t notifications;
+  BLECharacteristicEventHandler handlers[BLECharacteristicEventLast];
+};
+
+enum SimEventType
+{
+  SimConnect,
+  SimDisconnect,
+  SimWrite,
+  SimSubscribe,
+  SimAdvertisement // From a nearby device rather than a connected central
+};
+
+struct SimEvent
+{
+  SimEventType type;
+  SimCharacteristicState *characteristic;
+  std::vector<uint8_t> data;
+  bool enabled;
+  String address;
+  uint64_t atMillis; // SimAdvertisement: when it went on air
+};
+
+static std::vector<SimCharacteristicState *> characteristics;
+static std::deque<SimEvent> pendingEvents;
+static std::multimap<uint64_t, SimEvent> scheduledEvents; // Advertisements not yet on air, by virtual time
+static BLEDeviceEventHandler deviceHandlers[BLEDeviceLastEvent];
+static std::vector<std::string> centrals; // Connected centrals, oldest first
+
+struct SimLink
+{
+  uint16_t handle;
+  uint16_t interval; // 1.25ms units
+  uint16_t latency;
+  uint16_t supervisionTimeout; // 10ms units
+};
+static std::map<std::string, SimLink> links; // Per connected central
+static uint16_t nextHandle = 1;
+static uint16_t preferredMaxInterval = 40; // Used by a new link, like the PPCP
+static uint16_t preferredTimeout = 400;
+static std::vector<uint8_t> manufacturerData;        // As last set by the sketch
+static std::vector<uint8_t> onAirManufacturerData;   // As of the last advertise()
+static size_t advertisedServiceSize = 0;             // AD structure of the advertised UUID
+static std::vector<std::string> discovered;           // Addresses reported since scan()
+static uint64_t scanStartMillis = 0;
+
+static bool isConnected(const std::string &address)
+{
+  return std::find(centrals.begin(), centrals.end(), address) != centrals.end();
+}
+
+// The central an event without an explicit address comes from
+static std::string defaultCentral()
+{
+  return centrals.empty() ? std::string() : centrals.back();
+}
+
+static SimCharacteristicState *findCharacteristic(const char *uuid)
+{
+  for (SimCharacteristicState *state : characteristics)
+  {
+    if (strcasecmp(state->uuid, uuid) == 0)
+    {
+      return state;
+    }
+  }
+  return NULL;
+}
+
+// --- BLEDevice ---
+
+BLEDevice::BLEDevice() : _manufacturerDataLength(0)
+{
+  _address[0] = '\0';
+}
+
+BLEDevice::BLEDevice(const char *address) : _manufacturerDataLength(0)
+{
+  strncpy(_address, address, sizeof(_address) - 1);
+  _address[sizeof(_address) - 1] = '\0';
+}
+
+int BLEDevice::manufacturerData(uint8_t value[], int length) const
+{
+  int copied = _manufacturerDataLength < length ? _manufacturerDataLength : length;
+  memcpy(value, _manufacturerData, copied);
+  return copied;
+}
+
+String BLEDevice::address() const
+{
+  return String(_address);
+}
+
+bool BLEDevice::connected() const
+{
+  return isConnected(_address);
+}
+
+bool BLEDevice::disconnect()
+{
+  if (!connected())
+  {
+    return false;
+  }
+  simDisconnectCentral(_address);
+  return true;
+}
+
+bool BLEDevice::operator==(const BLEDevice &rhs) const
+{
+  return strcmp(_address, rhs._address) == 0;
+}
+
+// --- BLECharacteristic ---
+
+BLECharacteristic::BLECharacteristic() : _state(NULL)
+{
+}
+
+BLECharacteristic::BLECharacteristic(const char *uuid, uint8_t properties, int valueSize, bool fixedLength)
+{
+  (void)fixedLength;
+  _state = new SimCharacteristicState();
+  _state->uuid = uuid;
+  _state->properties = properties;
+  _state->valueSize = valueSize < (int)sizeof(_state->value) ? valueSize : sizeof(_state->value);
+}
+
+const char *BLECharacteristic::uuid() const { return _state->uuid; }
+uint8_t BLECharacteristic::properties() const { return _state->properties; }
+int BLECharacteristic::valueSize() const { return _state->valueSize; }
+const uint8_t *BLECharacteristic::value() const { return _state->value; }
+int BLECharacteristic::valueLength() const { return _state->valueLength; }
+bool BLECharacteristic::subscribed() { return !_state->subscribers.empty(); }
+
+int BLECharacteristic::writeValue(const uint8_t *value, int length, bool withResponse)
+{
+  (void)withResponse;
+  if (length > _state->valueSize)
+  {
+    return 0;
+  }
+  memcpy(_state->value, value, length);
+  _state->valueLength = length;
+  if (_state->properties & (BLENotify | BLEIndicate))
+  {
+    _state->notifications += _state->subscribers.size(); // One PDU per subscribed central
+  }
+  return 1;
+}
+
+void BLECharacteristic::setEventHandler(int event, BLECharacteristicEventHandler eventHandler)
+{
+  if (event >= 0 && event < BLECharacteristicEventLast)
+  {
+    _state->handlers[event] = eventHandler;
+  }
+}
+
+// --- BLEService ---
+
+BLEService::BLEService(const char *uuid) : _uuid(uuid), _characteristicCount(0)
+{
+}
+
+void BLEService::addCharacteristic(BLECharacteristic &characteristic)
+{
+  if (_characteristicCount < SIM_MAX_CHARACTERISTICS)
+  {
+    _characteristics[_characteristicCount++] = characteristic;
+  }
+}
+
+// --- BLELocalDevice ---
+
+int BLELocalDevice::begin() { return 1; }
+void BLELocalDevice::end() {}
+bool BLELocalDevice::setLocalName(const char *) { return true; }
+void BLELocalDevice::setDeviceName(const char *) {}
+bool BLELocalDevice::setAdvertisedService(const BLEService &service)
+{
+  size_t digits = 0;
+  for (const char *c = service.uuid(); *c; c++)
+  {
+    digits += *c != '-';
+  }
+  advertisedServiceSize = 2 + digits / 2;
+  return true;
+}
+
+bool BLELocalDevice::setManufacturerData(const uint8_t manufacturerData[], int manufacturerDataLength)
+{
+  ::manufacturerData.assign(manufacturerData, manufacturerData + manufacturerDataLength);
+  return true;
+}
+
+void BLELocalDevice::setAdvertisingInterval(uint16_t advertisingInterval)
+{
+  _advertisingInterval = advertisingInterval;
+}
+
+void BLELocalDevice::setConnectionInterval(uint16_t minimumConnectionInterval, uint16_t maximumConnectionInterval)
+{
+  (void)minimumConnectionInterval;
+  preferredMaxInterval = maximumConnectionInterval;
+}
+
+void BLELocalDevice::setSupervisionTimeout(uint16_t supervisionTimeout)
+{
+  preferredTimeout = supervisionTimeout;
+}
+
+// --- ATT / HCI internals ---
+
+uint16_t ATTClass::connectionHandle(uint8_t addressType, const uint8_t address[6]) const
+{
+  char text[18];
+  snprintf(text, sizeof(text), "%02x:%02x:%02x:%02x:%02x:%02x",
+           address[5], address[4], address[3], address[2], address[1], address[0]);
+  std::map<std::string, SimLink>::const_iterator link = links.find(text);
+  return addressType == 0x00 && link != links.end() ? link->second.handle : 0xFFFF;
+}
+
+int HCIClass::leConnUpdate(uint16_t handle, uint16_t minInterval, uint16_t maxInterval,
+                           uint16_t latency, uint16_t supervisionTimeout)
+{
+  (void)minInterval;
+  for (std::map<std::string, SimLink>::iterator link = links.begin(); link != links.end(); ++link)
+  {
+    if (link->second.handle == handle)
+    {
+      link->second.interval = maxInterval;
+      link->second.latency = latency;
+      link->second.supervisionTimeout = supervisionTimeout;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+int HCIClass::disconnect(uint16_t handle)
+{
+  for (std::map<std::string, SimLink>::iterator link = links.begin(); link != links.end(); ++link)
+  {
+    if (link->second.handle == handle)
+    {
+      std::string address = link->first; // simDisconnectCentral() erases the link
+      simDisconnectCentral(address.c_str());
+      return 0;
+    }
+  }
+  return -1;
+}
+
+String BLELocalDevice::address() const
+{
+  return String("c0:ff:ee:00:00:01");
+}
+
+void BLELocalDevice::addService(BLEService &service)
+{
+  for (int i = 0; i < service._characteristicCount; i++)
+  {
+    characteristics.push_back(service._characteristics[i]._state);
+  }
+}
+
+bool BLELocalDevice::connected() const
+{
+  return !centrals.empty();
+}
+
+BLEDevice BLELocalDevice::central()
+{
+  return centrals.empty() ? BLEDevice() : BLEDevice(centrals.back().c_str());
+}
+
+int BLELocalDevice::advertise()
+{
+  _advertising = centrals.size() < SIM_MAX_CONNECTIONS;
+  if (_advertising)
+  {
+    // The packet is built here, as in ArduinoBLE, which leaves out whatever
+    // does not fit after the flags and the advertised service
+    size_t packetSize = 3 + advertisedServiceSize + 2 + manufacturerData.size();
+    onAirManufacturerData = packetSize <= 31 ? manufacturerData : std::vector<uint8_t>();
+  }
+  return _advertising;
+}
+
+void BLELocalDevice::stopAdvertise()
+{
+  _advertising = false;
+}
+
+void BLELocalDevice::setEventHandler(BLEDeviceEvent event, BLEDeviceEventHandler eventHandler)
+{
+  if (event < BLEDeviceLastEvent)
+  {
+    deviceHandlers[event] = eventHandler;
+  }
+}
+
+int BLELocalDevice::scan(bool withDuplicates)
+{
+  _scanning = true;
+  _reportDuplicates = withDuplicates;
+  discovered.clear();
+  scanStartMillis = simNowMillis();
+  return 1;
+}
+
+void BLELocalDevice::stopScan()
+{
+  _scanning = false;
+}
+
+void BLELocalDevice::poll()
+{
+  poll(0);
+}
+
+// Scan report for an advertisement, if the sketch is listening for it
+void BLELocalDevice::deliverAdvertisement(const char *address, const uint8_t *data, int length, uint64_t atMillis)
+{
+  if (!_scanning || atMillis < scanStartMillis || !deviceHandlers[BLEDiscovered])
+  {
+    return; // Nobody was listening when it went on air: the packet is simply missed
+  }
+  if (!_reportDuplicates)
+  {
+    if (std::find(discovered.begin(), discovered.end(), address) != discovered.end())
+    {
+      return;
+    }
+    discovered.push_back(address);
+  }
+  BLEDevice peripheral(address);
+  peripheral._manufacturerDataLength = length < (int)sizeof(peripheral._manufacturerData) ? length : sizeof(peripheral._manufacturerData);
+  memcpy(peripheral._manufacturerData, data, peripheral._manufacturerDataLength);
+  deviceHandlers[BLEDiscovered](peripheral);
+}
+
+// With nothing to do, the "radio" stays quiet for the whole timeout and the
+// virtual clock moves forward instead. A scheduled advertisement ends the
+// wait early, as a scan report would.
+void SimHCITransport::wait(unsigned long timeout)
+{
+  uint64_t now = simNowMillis();
+  if (!pendingEvents.empty())
+  {
+    return;
+  }
+  if (!scheduledEvents.empty() && scheduledEvents.begin()->first <= now + timeout)
+  {
+    if (scheduledEvents.begin()->first > now)
+    {
+      simAdvanceMillis(scheduledEvents.begin()->first - now);
+    }
+    return;
+  }
+  simAdvanceMillis(timeout);
+}
+
+// Deliver every queued central event, after waiting up to timeout for one
+void BLELocalDevice::poll(unsigned long timeout)
+{
+  if (timeout)
+  {
+    HCITransport.wait(timeout);
+  }
+  while (!scheduledEvents.empty() && scheduledEvents.begin()->first <= simNowMillis())
+  {
+    pendingEvents.push_back(scheduledEvents.begin()->second);
+    scheduledEvents.erase(scheduledEvents.begin());
+  }
+
+  while (!pendingEvents.empty())
+  {
+    SimEvent event = pendingEvents.front();
+    pendingEvents.pop_front();
+
+    std::string address = event.address.length() ? std::string(event.address.c_str()) : defaultCentral();
+    if (event.type == SimAdvertisement)
+    {
+      deliverAdvertisement(address.c_str(), event.data.data(), event.data.size(), event.atMillis);
+      continue;
+    }
+    if (event.type != SimConnect && !isConnected(address))
+    {
+      continue; // The link is gone (or never existed)
+    }
+    BLEDevice central(address.c_str());
+    switch (event.type)
+    {
+    case SimConnect:
+      if (isConnected(address) || centrals.size() >= SIM_MAX_CONNECTIONS)
+      {
+        break;
+      }
+      centrals.push_back(address);
+      links[address] = SimLink{nextHandle++, preferredMaxInterval, 0, preferredTimeout};
+      _advertising = false; // Like the controller, stop advertising on a new link
+      if (deviceHandlers[BLEConnected])
+      {
+        deviceHandlers[BLEConnected](central);
+      }
+      break;
+    case SimDisconnect:
+      centrals.erase(std::find(centrals.begin(), centrals.end(), address));
+      links.erase(address);
+      for (SimCharacteristicState *state : characteristics)
+      {
+        state->subscribers.erase(std::remove(state->subscribers.begin(), state->subscribers.end(), address),
+                                 state->subscribers.end());
+      }
+      if (deviceHandlers[BLEDisconnected])
+      {
+        deviceHandlers[BLEDisconnected](central);
+      }
+      break;
+    case SimWrite:
+      memcpy(event.characteristic->value, event.data.data(), event.data.size());
+      event.characteristic->valueLength = event.data.size();
+      if (event.characteristic->handlers[BLEWritten])
+      {
+        BLECharacteristic characteristic;
+        characteristic._state = event.characteristic;
+        event.characteristic->handlers[BLEWritten](central, characteristic);
+      }
+      break;
+    case SimAdvertisement:
+      break; // Handled above
+    case SimSubscribe:
+    {
+      std::vector<std::string> &subscribers = event.characteristic->subscribers;
+      bool wasSubscribed = std::find(subscribers.begin(), subscribers.end(), address) != subscribers.end();
+      if (wasSubscribed == event.enabled)
+      {
+        break;
+      }
+      if (event.enabled)
+      {
+        subscribers.push_back(address);
+      }
+      else
+      {
+        subscribers.erase(std::find(subscribers.begin(), subscribers.end(), address));
+      }
+      int handlerEvent = event.enabled ? BLESubscribed : BLEUnsubscribed;
+      if (event.characteristic->handlers[handlerEvent])
+      {
+        BLECharacteristic characteristic;
+        characteristic._state = event.characteristic;
+        event.characteristic->handlers[handlerEvent](central, characteristic);
+      }
+      break;
+    }
+    }
+  }
+}
+
+// --- Simulated central ---
+
+void simConnectCentral(const char *address)
+{
+  SimEvent event = {SimConnect, NULL, {}, false, String(address)};
+  pendingEvents.push_back(event);
+}
+
+void simDisconnectCentral(const char *address)
+{
+  if (address)
+  {
+    SimEvent event = {SimDisconnect, NULL, {}, false, String(address)};
+    pendingEvents.push_back(event);
+    return;
+  }
+  for (const std::string &central : centrals)
+  {
+    SimEvent event = {SimDisconnect, NULL, {}, false, String(central.c_str())};
+    pendingEvents.push_back(event);
+  }
+}
+
+void simAdvertisement(const char *address, const uint8_t *manufacturerData, int length, uint64_t atMillis)
+{
+  SimEvent event = {SimAdvertisement, NULL, std::vector<uint8_t>(manufacturerData, manufacturerData + length), false, String(address), atMillis};
+  scheduledEvents.insert(std::make_pair(atMillis, event));
+}
+
+bool simCentralConnected(const char *address)
+{
+  return address ? isConnected(address) : !centrals.empty();
+}
+
+uint8_t simConnectedCentrals()
+{
+  return centrals.size();
+}
+
+bool simWriteCharacteristic(const char *uuid, const uint8_t *data, int length, const char *address)
+{
+  SimCharacteristicState *state = findCharacteristic(uuid);
+  if (!state || !(state->properties & (BLEWrite | BLEWriteWithoutResponse)) || length > state->valueSize)
+  {
+    return false;
+  }
+  SimEvent event = {SimWrite, state, std::vector<uint8_t>(data, data + length), false, String(address ? address : "")};
+  pendingEvents.push_back(event);
+  return true;
+}
+
+// Reads are answered synchronously by the stack; the BLERead handler runs
+// first so the sketch can refresh the value, as ArduinoBLE does
+int simReadCharacteristic(const char *uuid, uint8_t *data, int size, const char *address)
+{
+  SimCharacteristicState *state = findCharacteristic(uuid);
+  if (!state || !(state->properties & BLERead))
+  {
+    return -1;
+  }
+  if (state->handlers[BLERead])
+  {
+    BLECharacteristic characteristic;
+    characteristic._state = state;
+    state->handlers[BLERead](BLEDevice(address ? address : defaultCentral().c_str()), characteristic);
+  }
+  int length = state->valueLength < size ? state->valueLength : size;
+  memcpy(data, state->value, length);
+  return length;
+}
+
+bool simSubscribe(const char *uuid, bool enabled, const char *address)
+{
+  SimCharacteristicState *state = findCharacteristic(uuid);
+  if (!state || !(state->properties & (BLENotify | BLEIndicate)))
+  {
+    return false;
+  }
+  SimEvent event = {SimSubscribe, state, {}, enabled, String(address ? address : "")};
+  pendingEvents.push_back(event);
+  return true;
+}
+
+uint32_t simNotificationCount(const char *uuid)
+{
+  SimCharacteristicState *state = findCharacteristic(uuid);
+  return state ? state->notifications : 0;
+}
+
+bool simConnectionParameters(const char *address, uint16_t *interval, uint16_t *latency, uint16_t *supervisionTimeout)
+{
+  std::map<std::string, SimLink>::const_iterator link = links.find(address ? std::string(address) : defaultCentral());
+  if (link == links.end())
+  {
+    return false;
+  }
+  *interval = link->second.interval;
+  *latency = link->second.latency;
+  *supervisionTimeout = link->second.supervisionTimeout;
+  return true;
+}
+
+int simAdvertisedManufacturerData(uint8_t *data, int size)
+{
+  if (!BLE.advertising())
+  {
+    return -1;
+  }
+  int length = (int)onAirManufacturerData.size() < size ? (int)onAirManufacturerData.size() : size;
+  memcpy(data, onAirManufacturerData.data(), length);
+  return length;
+}
@@ -0,0 +1,159 @@
+#ifndef NATIVE_SIM_ARDUINO_BLE_H
+#define NATIVE_SIM_ARDUINO_BLE_H
+
+// Fake ArduinoBLE peripheral stack for the native build. Mirrors the subset of
+// the ArduinoBLE API used by the sketch; the remote side is driven through
+// the sim* functions in NativeSim.h.
+
+#include "Arduino.h"
+
+enum BLEProperty
+{
+  BLEBroadcast = 0x01,
+  BLERead = 0x02,
+  BLEWriteWithoutResponse = 0x04,
+  BLEWrite = 0x08,
+  BLENotify = 0x10,
+  BLEIndicate = 0x20
+};
+
+enum BLEDeviceEvent
+{
+  BLEConnected = 0,
+  BLEDisconnected = 1,
+  BLEDiscovered = 2,
+  BLEDeviceLastEvent
+};
+
+enum BLECharacteristicEvent
+{
+  BLESubscribed = 0,
+  BLEUnsubscribed = 1,
+  // BLERead = 2, defined with the properties (same as ArduinoBLE)
+  BLEWritten = 3,
+  BLEUpdated = BLEWritten,
+  BLECharacteristicEventLast
+};
+
+class BLEDevice
+{
+public:
+  BLEDevice();
+  explicit BLEDevice(const char *address);
+
+  String address() const;
+  bool connected() const;
+  bool disconnect();
+
+  // Advertising data of a discovered device (scan reports only)
+  bool hasManufacturerData() const { return _manufacturerDataLength > 0; }
+  int manufacturerDataLength() const { return _manufacturerDataLength; }
+  int manufacturerData(uint8_t value[], int length) const;
+
+  operator bool() const { return _address[0] != '\0'; }
+  bool operator==(const BLEDevice &rhs) const;
+  bool operator!=(const BLEDevice &rhs) const { return !(*this == rhs); }
+
+private:
+  friend class BLELocalDevice;
+  char _address[18];
+  uint8_t _manufacturerData[31]; // Fits any legacy advertising packet
+  int _manufacturerDataLength;
+};
+
+class BLECharacteristic;
+typedef void (*BLEDeviceEventHandler)(BLEDevice device);
+typedef void (*BLECharacteristicEventHandler)(BLEDevice device, BLECharacteristic characteristic);
+
+struct SimCharacteristicState;
+
+// Like the real class, copies are handles to the same local characteristic
+class BLECharacteristic
+{
+public:
+  BLECharacteristic();
+  BLECharacteristic(const char *uuid, uint8_t properties, int valueSize, bool fixedLength = false);
+
+  const char *uuid() const;
+  uint8_t properties() const;
+  int valueSize() const;
+  const uint8_t *value() const;
+  int valueLength() const;
+
+  int writeValue(const uint8_t *value, int length, bool withResponse = true);
+  bool subscribed();
+  void setEventHandler(int event, BLECharacteristicEventHandler eventHandler);
+
+  operator bool() const { return _state != NULL; }
+
+private:
+  friend class BLELocalDevice;
+  friend int simReadCharacteristic(const char *uuid, uint8_t *data, int size, const char *address);
+  SimCharacteristicState *_state;
+};
+
+#define SIM_MAX_CHARACTERISTICS 8
+
+class BLEService
+{
+public:
+  BLEService(const char *uuid);
+
+  const char *uuid() const { return _uuid; }
+  void addCharacteristic(BLECharacteristic &characteristic);
+
+private:
+  friend class BLELocalDevice;
+  const char *_uuid;
+  BLECharacteristic _characteristics[SIM_MAX_CHARACTERISTICS];
+  int _characteristicCount;
+};
+
+class BLELocalDevice
+{
+public:
+  int begin();
+  void end();
+
+  void poll();
+  void poll(unsigned long timeout);
+
+  bool connected() const;
+  BLEDevice central();
+  String address() const;
+
+  bool setLocalName(const char *localName);
+  void setDeviceName(const char *deviceName);
+  bool setAdvertisedService(const BLEService &service);
+  bool setManufacturerData(const uint8_t manufacturerData[], int manufacturerDataLength);
+  void addService(BLEService &service);
+
+  int advertise();
+  void stopAdvertise();
+  bool advertising() const { return _advertising; }
+  uint16_t advertisingInterval() const { return _advertisingInterval; } // Sim only
+
+  void setEventHandler(BLEDeviceEvent event, BLEDeviceEventHandler eventHandler);
+
+  // Observer role: BLEDiscovered is raised for each advertisement heard
+  // (once per address unless withDuplicates)
+  int scan(bool withDuplicates = false);
+  void stopScan();
+  bool scanning() const { return _scanning; } // Sim only
+
+  void setAdvertisingInterval(uint16_t advertisingInterval);
+  void setConnectionInterval(uint16_t minimumConnectionInterval, uint16_t maximumConnectionInterval);
+  void setSupervisionTimeout(uint16_t supervisionTimeout);
+
+private:
+  void deliverAdvertisement(const char *address, const uint8_t *data, int length, uint64_t atMillis);
+
+  bool _advertising = false;
+  uint16_t _advertisingInterval = 160;
+  bool _scanning = false;
+  bool _reportDuplicates = false;
+};
+
+extern BLELocalDevice BLE;
+
+#endif
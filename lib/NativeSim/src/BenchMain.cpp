@@ -0,0 +1,366 @@
+// Entry point of the loopback build (-DCTS_TRANSPORT=TRANSPORT_LOOPBACK):
+// drives the server through the in-memory transport and measures how long
+// its handlers take on the host, with no radio model in between.
+//
+//   .pio/build/native_loopback/program [--ops N] [--centrals K] [--max-notifications M]
+//   .pio/build/native_loopback/program --calendar
+//   .pio/build/native_loopback/program --parse
+//
+// K centrals connect and subscribe to Current Time, then one of them
+// performs N valid Current Time writes, N malformed ones and N reads. Each
+// handler call is timed on its own. The sketch's loop() runs between calls,
+// untimed, so tasks and the log drain keep up as they would on the device.
+// Built with -DCTS_PROFILER=1 (env:native_loopback_profile) it also prints
+// the probe table of Profiler.h. The run ends with a read of the diagnostics
+// characteristic. With --max-notifications it exits 1 if the centrals were
+// sent more than M Current Time notifications in total, so a run doubles as
+// a pass/fail check on the notify policy (see test/sim_scenarios.py).
+//
+// --calendar instead times the conversions of Calendar.h over a year of
+// timestamps, in both directions, and exits non-zero if any of them does not
+// round-trip.
+//
+// --parse times parseCurrentTime() on its own, on a year of valid payloads
+// and on payloads rejected for each reason, and exits non-zero if any of them
+// gets another result than expected.
+
+#include "Transport.h"
+
+#if CTS_TRANSPORT == TRANSPORT_LOOPBACK && !defined(CTS_FUZZ)
+
+#include <chrono>
+#include <stdio.h>
+#include "Arduino.h"
+#include "Calendar.h"
+#include "CtsCodec.h"
+#include "CurrentTimeParser.h"
+#include "EpochClock.h"
+#include "NativeSim.h"
+#include "Profiler.h"
+
+void setup();
+void loop();
+
+static const uint64_t referenceEpochAtBoot = 1748736000; // 2025-06-01 00:00:00, as in SimMain
+
+typedef std::chrono::steady_clock BenchClock;
+
+struct BenchResult
+{
+  uint64_t count;
+  uint64_t totalNanos;
+  uint64_t minNanos;
+  uint64_t maxNanos;
+};
+
+static void benchRecord(BenchResult &result, BenchClock::time_point start, BenchClock::time_point end)
+{
+  uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  result.count++;
+  result.totalNanos += nanos;
+  result.minNanos = result.count == 1 || nanos < result.minNanos ? nanos : result.minNanos;
+  result.maxNanos = nanos > result.maxNanos ? nanos : result.maxNanos;
+}
+
+static void benchReport(const char *name, const BenchResult &result)
+{
+  double mean = result.count ? (double)result.totalNanos / result.count : 0;
+  fprintf(stderr, "%-20s %10llu calls  mean %8.1f ns  min %6llu ns  max %8llu ns  %6.2f M calls/s\n",
+          name, (unsigned long long)result.count, mean, (unsigned long long)result.minNanos,
+          (unsigned long long)result.maxNanos, mean > 0 ? 1000.0 / mean : 0);
+}
+
+#if CTS_PROFILER
+static void profileTable()
+{
+  fprintf(stderr, "\n%-26s %10s %8s %8s %8s  histogram (count per log2 ns bucket, from 2^k ns)\n",
+          "probe", "calls", "min ns", "mean ns", "max ns");
+  for (uint8_t i = 0; i < PROFILE_PROBE_COUNT; i++)
+  {
+    const ProfileStats &stats = profileStats((ProfileProbeId)i);
+    if (!stats.count)
+    {
+      continue;
+    }
+    fprintf(stderr, "%-26s %10u %8u %8u %8u ", profileProbeLabel((ProfileProbeId)i), stats.count,
+            profileTicksToNanos(stats.minTicks), profileTicksToNanos(stats.totalTicks / stats.count),
+            profileTicksToNanos(stats.maxTicks));
+    for (uint8_t bucket = 0; bucket < PROFILE_HISTOGRAM_BUCKETS; bucket++)
+    {
+      if (stats.histogram[bucket])
+      {
+        fprintf(stderr, " 2^%u:%u", bucket ? bucket - 1 : 0, stats.histogram[bucket]);
+      }
+    }
+    fprintf(stderr, "\n");
+  }
+}
+#endif
+
+// --- Calendar ---
+
+static const uint64_t calendarYearStart = 1735689600; // 2025-01-01 00:00:00
+static const uint32_t calendarTimestamps = 365 * 24 * 60;  // One per minute of the year
+static const int calendarPasses = 20;
+
+// The timestamp a sample stands for: minute i of the year, second i % 60
+static uint64_t calendarTimestamp(uint32_t i)
+{
+  return calendarYearStart + (uint64_t)i * 60 + i % 60;
+}
+
+static void calendarReport(const char *name, BenchClock::duration elapsed)
+{
+  uint64_t count = (uint64_t)calendarTimestamps * calendarPasses;
+  double nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  fprintf(stderr, "%-20s %10llu conversions  %6.2f ns/conversion  %7.2f M conversions/s\n", name,
+          (unsigned long long)count, nanos / count, count * 1000.0 / nanos);
+}
+
+static uint64_t epochFromDate(const DateTime &date)
+{
+  return (uint64_t)Calendar::daysFromCivil(date.year, date.month, date.day) * 86400 +
+         (uint32_t)date.hour * 3600 + (uint32_t)date.minute * 60 + date.second;
+}
+
+// Epoch seconds to civil date and time of day and back, as EpochClock and the
+// Current Time parser do it, over a year of timestamps. The checksum keeps
+// the compiler from dropping the conversions; the round trip is checked
+// outside the timed loops.
+static int benchCalendar()
+{
+  static DateTime dates[calendarTimestamps];
+  BenchClock::time_point start = BenchClock::now();
+  for (int pass = 0; pass < calendarPasses; pass++)
+  {
+    for (uint32_t i = 0; i < calendarTimestamps; i++)
+    {
+      uint64_t seconds = calendarTimestamp(i);
+      uint32_t days = seconds / 86400;
+      uint32_t secondOfDay = seconds % 86400;
+      Calendar::CivilDate date = Calendar::civilFromDays(days);
+      dates[i] = {date.year, date.month, date.day, (uint8_t)(secondOfDay / 3600), (uint8_t)((secondOfDay / 60) % 60),
+                  (uint8_t)(secondOfDay % 60), Calendar::weekdayFromDays(days)};
+    }
+  }
+  BenchClock::duration toCivil = BenchClock::now() - start;
+
+  uint64_t checksum = 0;
+  start = BenchClock::now();
+  for (int pass = 0; pass < calendarPasses; pass++)
+  {
+    for (uint32_t i = 0; i < calendarTimestamps; i++)
+    {
+      checksum += epochFromDate(dates[i]);
+    }
+  }
+  BenchClock::duration toEpoch = BenchClock::now() - start;
+
+  uint32_t mismatches = 0;
+  for (uint32_t i = 0; i < calendarTimestamps; i++)
+  {
+    mismatches += epochFromDate(dates[i]) != calendarTimestamp(i);
+  }
+
+  fprintf(stderr, "calendar, one timestamp per minute of 2025, %d passes\n", calendarPasses);
+  calendarReport("epoch -> civil", toCivil);
+  calendarReport("civil -> epoch", toEpoch);
+  fprintf(stderr, "round-trip mismatches: %u (checksum %llu)\n", mismatches, (unsigned long long)checksum);
+  return mismatches ? 1 : 0;
+}
+
+static void encodeCurrentTime(uint64_t epochMillis, uint8_t adjustReason, uint8_t *data)
+{
+  uint64_t seconds = epochMillis / 1000;
+  uint32_t days = seconds / 86400;
+  uint32_t secondOfDay = seconds % 86400;
+  Calendar::CivilDate date = Calendar::civilFromDays(days);
+  CtsCurrentTime currentTime = {date.year, date.month, date.day,
+                                (uint8_t)(secondOfDay / 3600), (uint8_t)((secondOfDay / 60) % 60), (uint8_t)(secondOfDay % 60),
+                                Calendar::weekdayFromDays(days),
+                                (uint8_t)((epochMillis % 1000) * 256 / 1000),
+                                adjustReason};
+  currentTime.encode(data);
+}
+
+// --- Current Time parser ---
+
+static const uint32_t parsePayloads = 365 * 24; // One per hour of 2025
+static const int parsePasses = 200;
+
+struct ParseCase
+{
+  const char *name;
+  CurrentTimeParseResult expected;
+  size_t length;
+  // Corrupts a valid payload (NULL: leave it valid)
+  void (*corrupt)(uint8_t *data);
+};
+
+static void corruptYear(uint8_t *data) { data[0] = 0x00, data[1] = 0x00; }
+static void corruptDate(uint8_t *data) { data[3] = Calendar::daysInMonth(data[0] | data[1] << 8, data[2]) + 1; }
+static void corruptTime(uint8_t *data) { data[4] = 24 + data[4] % 8; }     // Hour 24..31
+static void corruptDayOfWeek(uint8_t *data) { data[7] = data[7] % 7 + 1; } // The next weekday
+
+static const ParseCase parseCases[] = {
+    {"valid", CURRENT_TIME_OK, CtsCurrentTime::WIRE_SIZE, NULL},
+    {"bad length", CURRENT_TIME_BAD_LENGTH, 3, NULL},
+    {"bad year", CURRENT_TIME_BAD_YEAR, CtsCurrentTime::WIRE_SIZE, corruptYear},
+    {"bad date", CURRENT_TIME_BAD_DATE, CtsCurrentTime::WIRE_SIZE, corruptDate},
+    {"bad time", CURRENT_TIME_BAD_TIME, CtsCurrentTime::WIRE_SIZE, corruptTime},
+    {"bad day of week", CURRENT_TIME_BAD_DAY_OF_WEEK, CtsCurrentTime::WIRE_SIZE, corruptDayOfWeek},
+};
+
+// Parse throughput per kind of payload; every payload's result is checked
+// against the expected one outside the timed loop.
+static int benchParse()
+{
+  static uint8_t payloads[parsePayloads][CtsCurrentTime::WIRE_SIZE];
+  uint32_t mismatches = 0;
+  fprintf(stderr, "parseCurrentTime, one payload per hour of 2025, %d passes\n", parsePasses);
+  for (const ParseCase &parseCase : parseCases)
+  {
+    for (uint32_t i = 0; i < parsePayloads; i++)
+    {
+      encodeCurrentTime((calendarYearStart + (uint64_t)i * 3600 + i % 60) * 1000, CTS_ADJUST_MANUAL, payloads[i]);
+      if (parseCase.corrupt)
+      {
+        parseCase.corrupt(payloads[i]);
+      }
+    }
+
+    uint32_t accepted = 0;
+    ParsedCurrentTime parsed;
+    BenchClock::time_point start = BenchClock::now();
+    for (int pass = 0; pass < parsePasses; pass++)
+    {
+      for (uint32_t i = 0; i < parsePayloads; i++)
+      {
+        accepted += parseCurrentTime(payloads[i], parseCase.length, parsed) == CURRENT_TIME_OK;
+      }
+    }
+    BenchClock::duration elapsed = BenchClock::now() - start;
+
+    uint32_t matching = 0;
+    for (uint32_t i = 0; i < parsePayloads; i++)
+    {
+      matching += parseCurrentTime(payloads[i], parseCase.length, parsed) == parseCase.expected;
+    }
+    mismatches += parsePayloads - matching;
+
+    uint64_t count = (uint64_t)parsePayloads * parsePasses;
+    double nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    fprintf(stderr, "%-20s %10llu payloads  %6.2f ns/payload  %7.2f M payloads/s  (%u accepted)\n", parseCase.name,
+            (unsigned long long)count, nanos / count, count * 1000.0 / nanos, accepted / parsePasses);
+  }
+  fprintf(stderr, "unexpected results: %u\n", mismatches);
+  return mismatches ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+  uint64_t ops = 1000000;
+  int centrals = 1;
+  int64_t maxNotifications = -1; // No limit
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--ops") == 0 && i + 1 < argc)
+    {
+      ops = strtoull(argv[++i], NULL, 10);
+    }
+    else if (strcmp(argv[i], "--centrals") == 0 && i + 1 < argc)
+    {
+      centrals = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--max-notifications") == 0 && i + 1 < argc)
+    {
+      maxNotifications = atoll(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--calendar") == 0)
+    {
+      return benchCalendar();
+    }
+    else if (strcmp(argv[i], "--parse") == 0)
+    {
+      return benchParse();
+    }
+    else
+    {
+      fprintf(stderr, "usage: %s [--ops N] [--centrals K] [--max-notifications M] | --calendar | --parse\n", argv[0]);
+      return 2;
+    }
+  }
+
+  setup();
+  TransportPeer peers[LOOPBACK_MAX_PEERS];
+  centrals = centrals < 1 ? 1 : (centrals > LOOPBACK_MAX_PEERS ? LOOPBACK_MAX_PEERS : centrals);
+  for (int i = 0; i < centrals; i++)
+  {
+    BleAddress address = {{(uint8_t)(i + 1), 0x00, 0x00, 0x38, 0xc1, 0xa4}}; // a4:c1:38:00:00:0N
+    peers[i] = TransportPeer(address);
+    loopbackConnect(peers[i]);
+    loopbackSubscribe(peers[i], GATT_CURRENT_TIME, true);
+    loop();
+  }
+  const TransportPeer &writer = peers[0];
+
+  BenchResult writes = {}, rejects = {}, reads = {};
+  uint8_t data[CtsCurrentTime::WIRE_SIZE];
+  const uint8_t malformed[3] = {0xE9, 0x07, 6}; // Truncated: rejected on its length
+  for (uint64_t i = 0; i < ops; i++)
+  {
+    // A client re-syncing from network time: small external adjustments are
+    // rate limited, where manual ones would each notify every subscriber
+    encodeCurrentTime(referenceEpochAtBoot * 1000 + simNowMillis(), CTS_ADJUST_EXTERNAL_REFERENCE, data);
+    BenchClock::time_point start = BenchClock::now();
+    loopbackWrite(writer, GATT_CURRENT_TIME, data, sizeof(data));
+    benchRecord(writes, start, BenchClock::now());
+    loop();
+  }
+  for (uint64_t i = 0; i < ops; i++)
+  {
+    BenchClock::time_point start = BenchClock::now();
+    loopbackWrite(writer, GATT_CURRENT_TIME, malformed, sizeof(malformed));
+    benchRecord(rejects, start, BenchClock::now());
+    loop();
+  }
+  for (uint64_t i = 0; i < ops; i++)
+  {
+    BenchClock::time_point start = BenchClock::now();
+    loopbackRead(writer, GATT_CURRENT_TIME, data, sizeof(data));
+    benchRecord(reads, start, BenchClock::now());
+    loop();
+  }
+
+  fprintf(stderr, "loopback transport, %d central(s) subscribed, %llu simulated ms\n",
+          centrals, (unsigned long long)simNowMillis());
+  benchReport("current time write", writes);
+  benchReport("rejected write", rejects);
+  benchReport("current time read", reads);
+  uint32_t notifications = loopbackNotificationCount(GATT_CURRENT_TIME);
+  fprintf(stderr, "notifications: %u\n", notifications);
+
+  // The same counters as the gateway sees them through the diagnostics service
+  uint8_t diagnosticsData[CtsDiagnostics::WIRE_SIZE];
+  if (loopbackRead(writer, GATT_DIAGNOSTICS, diagnosticsData, sizeof(diagnosticsData)) == (int)sizeof(diagnosticsData))
+  {
+    CtsDiagnostics diagnostics = CtsDiagnostics::decode(diagnosticsData);
+    fprintf(stderr, "diagnostics: %u writes accepted, %u rejected, %u notifications, %u connects, %u scheduler overruns\n",
+            diagnostics.timeWritesAccepted, diagnostics.timeWritesRejected, diagnostics.notificationsSent,
+            diagnostics.connects, diagnostics.schedulerOverruns);
+    fprintf(stderr, "advertising phases (links/s): fast %u/%u, medium %u/%u, slow %u/%u\n",
+            diagnostics.fastPhaseConnections, diagnostics.fastPhaseSeconds, diagnostics.mediumPhaseConnections,
+            diagnostics.mediumPhaseSeconds, diagnostics.slowPhaseConnections, diagnostics.slowPhaseSeconds);
+  }
+#if CTS_PROFILER
+  profileTable();
+#endif
+  if (maxNotifications >= 0 && notifications > maxNotifications)
+  {
+    fprintf(stderr, "FAIL: more than %lld notifications\n", (long long)maxNotifications);
+    return 1;
+  }
+  return 0;
+}
+
+#endif
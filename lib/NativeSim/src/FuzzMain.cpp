@@ -0,0 +1,162 @@
+// Entry point of the parser fuzz build (-DCTS_FUZZ, env:native_fuzz): feeds
+// parseCurrentTime() arbitrary payloads, under AddressSanitizer and
+// UndefinedBehaviorSanitizer, and aborts when an accepted one breaks an
+// invariant of ParsedCurrentTime.
+//
+//   .pio/build/native_fuzz/program [--runs N] [--seed S]
+//
+// The built-in driver mixes payloads of random length and content with
+// single-byte mutations of valid Current Time payloads, which reach the
+// calendar checks far more often, and prints how many of them ended in each
+// parse result. LLVMFuzzerTestOneInput() is also a libFuzzer target: built
+// with clang, -DCTS_LIBFUZZER and -fsanitize=fuzzer, libFuzzer supplies
+// main() and drives it instead.
+
+#ifdef CTS_FUZZ
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Calendar.h"
+#include "CtsCodec.h"
+#include "CurrentTimeParser.h"
+
+static void fuzzCheck(bool condition, const char *invariant, const uint8_t *data, size_t length)
+{
+  if (condition)
+  {
+    return;
+  }
+  fprintf(stderr, "invariant broken: %s\npayload:", invariant);
+  for (size_t i = 0; i < length; i++)
+  {
+    fprintf(stderr, " %02x", data[i]);
+  }
+  fprintf(stderr, "\n");
+  abort();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t length)
+{
+  ParsedCurrentTime parsed;
+  if (parseCurrentTime(data, length, parsed) != CURRENT_TIME_OK)
+  {
+    return 0;
+  }
+
+  // Accepted: the epoch seconds must convert back to exactly the date and
+  // time that was written
+  CtsCurrentTime::View written(data);
+  uint32_t days = parsed.epochSeconds / 86400;
+  uint32_t secondOfDay = parsed.epochSeconds % 86400;
+  Calendar::CivilDate date = Calendar::civilFromDays(days);
+  fuzzCheck(length == CtsCurrentTime::WIRE_SIZE, "length", data, length);
+  fuzzCheck(written.year() >= CTS_YEAR_MIN && written.year() <= CTS_YEAR_MAX, "year range", data, length);
+  fuzzCheck(date.year == written.year() && date.month == written.month() && date.day == written.day(),
+            "date round trip", data, length);
+  fuzzCheck(written.hour() == secondOfDay / 3600 && written.minute() == (secondOfDay / 60) % 60 &&
+                written.second() == secondOfDay % 60,
+            "time of day round trip", data, length);
+  fuzzCheck(written.dayOfWeek() == 0 || written.dayOfWeek() == Calendar::weekdayFromDays(days), "day of week",
+            data, length);
+  fuzzCheck(parsed.fractions256 == written.fractions256(), "fractions", data, length);
+  fuzzCheck((parsed.adjustReason & ~CTS_ADJUST_MASK) == 0, "adjust reason mask", data, length);
+  return 0;
+}
+
+#ifndef CTS_LIBFUZZER
+
+// --- Built-in driver ---
+
+// xorshift64*, so a seed reproduces a run on any host
+static uint64_t fuzzState = 1;
+
+static uint32_t fuzzRandom()
+{
+  fuzzState ^= fuzzState >> 12;
+  fuzzState ^= fuzzState << 25;
+  fuzzState ^= fuzzState >> 27;
+  return (fuzzState * 0x2545F4914F6CDD1DULL) >> 32;
+}
+
+// A valid Current Time payload for a random second between CTS_YEAR_MIN
+// and CTS_YEAR_MAX
+static void fuzzValidPayload(uint8_t *data)
+{
+  uint32_t lastDay = Calendar::daysFromCivil(CTS_YEAR_MAX, 12, 31);
+  uint32_t days = fuzzRandom() % (lastDay + 1);
+  uint32_t secondOfDay = fuzzRandom() % 86400;
+  Calendar::CivilDate date = Calendar::civilFromDays(days);
+  CtsCurrentTime currentTime = {date.year, date.month, date.day,
+                                (uint8_t)(secondOfDay / 3600), (uint8_t)((secondOfDay / 60) % 60), (uint8_t)(secondOfDay % 60),
+                                (uint8_t)(fuzzRandom() % 2 ? Calendar::weekdayFromDays(days) : 0),
+                                (uint8_t)fuzzRandom(), (uint8_t)fuzzRandom()};
+  currentTime.encode(data);
+}
+
+int main(int argc, char **argv)
+{
+  uint64_t runs = 10000000;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+    {
+      runs = strtoull(argv[++i], NULL, 10);
+    }
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+    {
+      fuzzState = strtoull(argv[++i], NULL, 10) | 1;
+    }
+    else
+    {
+      fprintf(stderr, "usage: %s [--runs N] [--seed S]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  static const char *const resultNames[] = {"ok", "bad length", "bad year", "bad date", "bad time", "bad day of week"};
+  uint64_t results[sizeof(resultNames) / sizeof(resultNames[0])] = {};
+  uint8_t data[2 * CtsCurrentTime::WIRE_SIZE];
+  for (uint64_t run = 0; run < runs; run++)
+  {
+    size_t length;
+    if (run % 4 == 0)
+    {
+      // Random bytes, of a length around the valid one
+      length = fuzzRandom() % sizeof(data);
+      for (size_t i = 0; i < length; i++)
+      {
+        data[i] = fuzzRandom();
+      }
+    }
+    else
+    {
+      // A valid payload with up to two bytes replaced
+      length = CtsCurrentTime::WIRE_SIZE;
+      fuzzValidPayload(data);
+      for (uint32_t mutations = fuzzRandom() % 3; mutations > 0; mutations--)
+      {
+        data[fuzzRandom() % length] = fuzzRandom();
+      }
+    }
+
+    // Parse a heap copy of exactly the payload's length, so AddressSanitizer
+    // catches a read past its end
+    uint8_t *payload = (uint8_t *)malloc(length ? length : 1);
+    memcpy(payload, data, length);
+    ParsedCurrentTime parsed;
+    results[parseCurrentTime(payload, length, parsed)]++;
+    LLVMFuzzerTestOneInput(payload, length);
+    free(payload);
+  }
+
+  fprintf(stderr, "%llu payloads\n", (unsigned long long)runs);
+  for (size_t i = 0; i < sizeof(results) / sizeof(results[0]); i++)
+  {
+    fprintf(stderr, "  %-16s %12llu\n", resultNames[i], (unsigned long long)results[i]);
+  }
+  return 0;
+}
+
+#endif
+#endif
@@ -0,0 +1,49 @@
+#ifndef NATIVE_SIM_H
+#define NATIVE_SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Control surface of the native simulation: a virtual clock behind millis()
+// and a scripted central that talks to the fake ArduinoBLE stack.
+
+// --- Virtual clock ---
+uint64_t simNowMillis();
+void simAdvanceMillis(uint32_t ms);
+// Make the watch's millis()/micros() run fast (positive) or slow relative to
+// the simulation's reference time, like an off-nominal crystal
+void simSetClockDriftPpm(int32_t ppm);
+
+// --- Serial ---
+// Serial output is discarded unless enabled (long replays print a lot)
+void simSetSerialOutput(bool enabled);
+// What Serial.availableForWrite() reports (64 by default); 0 stands for a
+// port that does not implement it, like Print's default
+void simSetSerialWriteSpace(int bytes);
+
+// --- Simulated centrals ---
+// Events are queued and delivered from the next BLE.poll(), like the radio.
+// Up to SIM_MAX_CONNECTIONS centrals can be connected at once; an address of
+// NULL means the most recently connected one (or, for disconnect, all).
+#define SIM_MAX_CONNECTIONS 8
+void simConnectCentral(const char *address);
+void simDisconnectCentral(const char *address = NULL);
+bool simCentralConnected(const char *address = NULL);
+uint8_t simConnectedCentrals();
+bool simWriteCharacteristic(const char *uuid, const uint8_t *data, int length, const char *address = NULL);
+int simReadCharacteristic(const char *uuid, uint8_t *data, int size, const char *address = NULL);
+bool simSubscribe(const char *uuid, bool enabled, const char *address = NULL);
+// Number of notifications/indications sent for a characteristic
+uint32_t simNotificationCount(const char *uuid);
+// Manufacturer data in the advertising packet a scanner would receive now;
+// -1 when not advertising
+int simAdvertisedManufacturerData(uint8_t *data, int size);
+// A nearby device (not a connected central) sends one advertisement at
+// virtual time atMillis (or now, if that has passed). BLE.poll() wakes up for
+// it and the sketch sees BLEDiscovered if it is scanning at that moment.
+void simAdvertisement(const char *address, const uint8_t *manufacturerData, int length, uint64_t atMillis = 0);
+// Current parameters of a central's link (interval in 1.25ms units,
+// timeout in 10ms units); false when it is not connected
+bool simConnectionParameters(const char *address, uint16_t *interval, uint16_t *latency, uint16_t *supervisionTimeout);
+
+#endif
@@ -0,0 +1,251 @@
+// Entry point of the native build: runs the sketch's setup()/loop() against
+// the virtual clock and replays days of simulated time in a few seconds.
+//
+//   .pio/build/native/program [--days N] [--sync-hours H] [--drift-ppm P] [--gateway] [--verbose]
+//                             [--serial-space B] [--max-offset-ms M]
+//
+// A simulated central syncs the watch at boot and every H hours (0 = never);
+// with --gateway the boot sync is left to a stand-in time gateway instead,
+// whose transmissions are read from stdin (see python_cts_client/gateway.py):
+//
+//   <reference epoch ms> <address> <manufacturer data hex>
+//
+// one line per advertisement, in time order. At the end the watch's Current Time is read back and compared with the
+// reference clock of the simulation. --drift-ppm makes the watch's millis()
+// run off-nominal so drift compensation can be exercised.
+//
+// With --verbose the sketch's Serial output (binary trace frames) goes to
+// stdout and the summary to stderr, so the trace can be piped straight into
+// python_cts_client/trace_decode.py. --serial-space sets what
+// Serial.availableForWrite() reports; 0 models a port that does not
+// implement it.
+//
+// The exit code is 1 if the Current Time could not be read back or, with
+// --max-offset-ms, if the watch is further than M ms off the reference, so
+// a run doubles as a pass/fail check (see test/sim_scenarios.py).
+//
+// The loopback transport build has its own entry point (BenchMain.cpp), and
+// so does the parser fuzz build (FuzzMain.cpp).
+
+#include "Transport.h"
+
+#if CTS_TRANSPORT == TRANSPORT_ARDUINO_BLE && !defined(CTS_FUZZ)
+
+#include <chrono>
+#include <stdio.h>
+#include "Arduino.h"
+#include "Calendar.h"
+#include "CtsCodec.h"
+#include "NativeSim.h"
+
+void setup();
+void loop();
+
+static const char *const currentTimeUUID = "2A2B";
+static const char *const centralAddress = "a4:c1:38:00:00:01";
+static const uint64_t referenceEpochAtBoot = 1748736000; // 2025-06-01 00:00:00
+
+static uint64_t loopIterations = 0;
+
+#define GATEWAY_LOOKAHEAD_MS 5000 // Hand gateway packets to the radio this far ahead (> one loop's sleep)
+
+// One advertisement of the stand-in gateway
+struct GatewayTransmission
+{
+  uint64_t simMillis; // When it goes on air, on the simulation's clock
+  char address[18];
+  uint8_t data[31];
+  int length;
+};
+
+static uint64_t referenceEpochMillis()
+{
+  return referenceEpochAtBoot * 1000 + simNowMillis();
+}
+
+// Run loop() until the virtual clock has moved by at least ms
+static void runFor(uint64_t ms)
+{
+  uint64_t until = simNowMillis() + ms;
+  while (simNowMillis() < until)
+  {
+    uint64_t before = simNowMillis();
+    loop();
+    loopIterations++;
+    if (simNowMillis() == before)
+    {
+      simAdvanceMillis(1); // Busy-poll builds never sleep on their own
+    }
+  }
+}
+
+static void encodeCurrentTime(uint64_t epochMillis, uint8_t *data)
+{
+  uint64_t seconds = epochMillis / 1000;
+  uint32_t days = seconds / 86400;
+  uint32_t secondOfDay = seconds % 86400;
+  Calendar::CivilDate date = Calendar::civilFromDays(days);
+  CtsCurrentTime currentTime = {date.year, date.month, date.day,
+                                (uint8_t)(secondOfDay / 3600), (uint8_t)((secondOfDay / 60) % 60), (uint8_t)(secondOfDay % 60),
+                                Calendar::weekdayFromDays(days),
+                                (uint8_t)((epochMillis % 1000) * 256 / 1000),
+                                1}; // Manual time update
+  currentTime.encode(data);
+}
+
+static int64_t decodeCurrentTimeMillis(const uint8_t *data)
+{
+  CtsCurrentTime::View time(data);
+  uint32_t days = Calendar::daysFromCivil(time.year(), time.month(), time.day());
+  int64_t seconds = (int64_t)days * 86400 + time.hour() * 3600 + time.minute() * 60 + time.second();
+  return seconds * 1000 + time.fractions256() * 1000 / 256;
+}
+
+// Next transmission from the gateway script; false at the end of the input.
+// Blank lines and lines starting with # are skipped.
+static bool readGatewayTransmission(FILE *input, GatewayTransmission &transmission)
+{
+  char line[256];
+  while (fgets(line, sizeof(line), input))
+  {
+    unsigned long long epochMillis;
+    char hex[2 * sizeof(transmission.data) + 1];
+    if (line[0] == '#' || sscanf(line, "%llu %17s %62s", &epochMillis, transmission.address, hex) != 3)
+    {
+      continue;
+    }
+    transmission.length = strlen(hex) / 2;
+    for (int i = 0; i < transmission.length; i++)
+    {
+      unsigned int byte;
+      sscanf(hex + 2 * i, "%2x", &byte);
+      transmission.data[i] = byte;
+    }
+    uint64_t bootMillis = referenceEpochAtBoot * 1000;
+    transmission.simMillis = epochMillis > bootMillis ? epochMillis - bootMillis : 0;
+    return true;
+  }
+  return false;
+}
+
+static void syncOnce()
+{
+  simConnectCentral(centralAddress);
+  runFor(100);
+  uint8_t data[CtsCurrentTime::WIRE_SIZE];
+  encodeCurrentTime(referenceEpochMillis(), data);
+  simWriteCharacteristic(currentTimeUUID, data, sizeof(data));
+  runFor(100);
+  simDisconnectCentral();
+  runFor(100);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t days = 14;
+  uint32_t syncHours = 0;
+  bool verbose = false;
+  bool gateway = false;
+  int64_t maxOffsetMillis = -1; // No limit
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--days") == 0 && i + 1 < argc)
+    {
+      days = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--sync-hours") == 0 && i + 1 < argc)
+    {
+      syncHours = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--drift-ppm") == 0 && i + 1 < argc)
+    {
+      simSetClockDriftPpm(atoi(argv[++i]));
+    }
+    else if (strcmp(argv[i], "--gateway") == 0)
+    {
+      gateway = true;
+    }
+    else if (strcmp(argv[i], "--verbose") == 0)
+    {
+      verbose = true;
+    }
+    else if (strcmp(argv[i], "--serial-space") == 0 && i + 1 < argc)
+    {
+      simSetSerialWriteSpace(atoi(argv[++i]));
+    }
+    else if (strcmp(argv[i], "--max-offset-ms") == 0 && i + 1 < argc)
+    {
+      maxOffsetMillis = atoll(argv[++i]);
+    }
+    else
+    {
+      fprintf(stderr, "usage: %s [--days N] [--sync-hours H] [--drift-ppm P] [--gateway] [--verbose] [--serial-space B]"
+                      " [--max-offset-ms M]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  simSetSerialOutput(verbose);
+
+  auto wallStart = std::chrono::steady_clock::now();
+
+  setup();
+  if (!gateway)
+  {
+    syncOnce();
+  }
+
+  GatewayTransmission transmission;
+  bool transmissionPending = gateway && readGatewayTransmission(stdin, transmission);
+  uint32_t transmissions = 0;
+
+  uint64_t endMillis = simNowMillis() + (uint64_t)days * 86400000;
+  uint64_t syncMillis = (uint64_t)syncHours * 3600000;
+  uint64_t nextSync = syncMillis ? simNowMillis() + syncMillis : UINT64_MAX;
+  while (simNowMillis() < endMillis)
+  {
+    while (transmissionPending && transmission.simMillis <= simNowMillis() + GATEWAY_LOOKAHEAD_MS)
+    {
+      simAdvertisement(transmission.address, transmission.data, transmission.length, transmission.simMillis);
+      transmissions++;
+      transmissionPending = readGatewayTransmission(stdin, transmission);
+    }
+    runFor(nextSync - simNowMillis() < 1000 ? nextSync - simNowMillis() : 1000);
+    if (simNowMillis() >= nextSync)
+    {
+      syncOnce();
+      nextSync += syncMillis;
+    }
+  }
+
+  // Read the watch's notion of time back through the characteristic
+  simConnectCentral(centralAddress);
+  runFor(2000);
+  uint8_t data[CtsCurrentTime::WIRE_SIZE];
+  int length = simReadCharacteristic(currentTimeUUID, data, sizeof(data));
+  int64_t offset = length == CtsCurrentTime::WIRE_SIZE ? decodeCurrentTimeMillis(data) - (int64_t)referenceEpochMillis() : 0;
+  simDisconnectCentral();
+  runFor(100);
+
+  double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  fprintf(stderr, "simulated %u days in %.3f s (%llu loop iterations)\n",
+          days, wallSeconds, (unsigned long long)loopIterations);
+  if (gateway)
+  {
+    fprintf(stderr, "gateway advertisements sent: %u\n", transmissions);
+  }
+  fprintf(stderr, "watch offset from reference: %lld ms\n", (long long)offset);
+  if (length != CtsCurrentTime::WIRE_SIZE)
+  {
+    fprintf(stderr, "FAIL: Current Time could not be read back\n");
+    return 1;
+  }
+  if (maxOffsetMillis >= 0 && (offset > maxOffsetMillis || offset < -maxOffsetMillis))
+  {
+    fprintf(stderr, "FAIL: offset beyond %lld ms\n", (long long)maxOffsetMillis);
+    return 1;
+  }
+  return 0;
+}
+
+#endif
@@ -0,0 +1,18 @@
+#include "Timebase.h"
+
+// Host fake of the nRF52 RTC backend: a 32.768 kHz counter derived from the
+// virtual (drift-affected) micros() clock, wrapping at 2^32 like the real one
+#if CTS_TIMEBASE == TIMEBASE_NRF52_RTC
+
+#include "Arduino.h"
+
+void timebaseBegin()
+{
+}
+
+uint32_t timebaseNow()
+{
+  return (uint32_t)((uint64_t)micros() * TIMEBASE_TICKS_PER_SECOND / 1000000);
+}
+
+#endif
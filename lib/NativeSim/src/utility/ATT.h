@@ -0,0 +1,17 @@
+#ifndef NATIVE_SIM_UTILITY_ATT_H
+#define NATIVE_SIM_UTILITY_ATT_H
+
+// Fake of ArduinoBLE's internal ATT layer: just the connection handle lookup
+
+#include <stdint.h>
+
+class ATTClass
+{
+public:
+  // 0xFFFF when no link to that address exists (the sim only uses public addresses)
+  uint16_t connectionHandle(uint8_t addressType, const uint8_t address[6]) const;
+};
+
+extern ATTClass ATT;
+
+#endif
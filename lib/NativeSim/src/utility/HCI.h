@@ -0,0 +1,21 @@
+#ifndef NATIVE_SIM_UTILITY_HCI_H
+#define NATIVE_SIM_UTILITY_HCI_H
+
+// Fake of ArduinoBLE's internal HCI layer: connection parameter updates,
+// which the simulated central always accepts (see simConnectionParameters()),
+// and link termination
+
+#include <stdint.h>
+
+class HCIClass
+{
+public:
+  // 0 on success, like the status returned by the real command
+  int leConnUpdate(uint16_t handle, uint16_t minInterval, uint16_t maxInterval,
+                   uint16_t latency, uint16_t supervisionTimeout);
+  int disconnect(uint16_t handle);
+};
+
+extern HCIClass HCI;
+
+#endif
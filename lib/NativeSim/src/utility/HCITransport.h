@@ -0,0 +1,16 @@
+#ifndef NATIVE_SIM_UTILITY_HCI_TRANSPORT_H
+#define NATIVE_SIM_UTILITY_HCI_TRANSPORT_H
+
+// Fake of ArduinoBLE's HCI transport: only the wait for controller data,
+// which moves the virtual clock instead of sleeping
+
+class HCITransportInterface
+{
+public:
+  // Returns once an event is pending or timeout ms have passed
+  virtual void wait(unsigned long timeout) = 0;
+};
+
+extern HCITransportInterface &HCITransport;
+
+#endif
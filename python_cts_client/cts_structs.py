@@ -0,0 +1,75 @@
+"""CTS 封包定義（由 gen_cts_structs.py 依 include/CtsSchema.h 產生，請勿手動修改）。"""
+import struct
+from collections import namedtuple
+
+
+class CurrentTime(namedtuple("CurrentTime", "year month day hour minute second day_of_week fractions256 adjust_reason")):
+    FORMAT = struct.Struct("<HBBBBBBBB")
+    SIZE = 10
+
+    def pack(self) -> bytes:
+        return self.FORMAT.pack(*self)
+
+    @classmethod
+    def unpack(cls, data: bytes) -> "CurrentTime":
+        return cls._make(cls.FORMAT.unpack(bytes(data[:cls.SIZE])))
+
+
+class LocalTimeInfo(namedtuple("LocalTimeInfo", "time_zone dst_offset")):
+    FORMAT = struct.Struct("<bB")
+    SIZE = 2
+
+    def pack(self) -> bytes:
+        return self.FORMAT.pack(*self)
+
+    @classmethod
+    def unpack(cls, data: bytes) -> "LocalTimeInfo":
+        return cls._make(cls.FORMAT.unpack(bytes(data[:cls.SIZE])))
+
+
+class ReferenceTimeInfo(namedtuple("ReferenceTimeInfo", "source accuracy days_since_update hours_since_update")):
+    FORMAT = struct.Struct("<BBBB")
+    SIZE = 4
+
+    def pack(self) -> bytes:
+        return self.FORMAT.pack(*self)
+
+    @classmethod
+    def unpack(cls, data: bytes) -> "ReferenceTimeInfo":
+        return cls._make(cls.FORMAT.unpack(bytes(data[:cls.SIZE])))
+
+
+class TimeBeacon(namedtuple("TimeBeacon", "version epoch_seconds seconds_since_sync drift_ppb error_estimate_ms")):
+    FORMAT = struct.Struct("<BIIiH")
+    SIZE = 15
+
+    def pack(self) -> bytes:
+        return self.FORMAT.pack(*self)
+
+    @classmethod
+    def unpack(cls, data: bytes) -> "TimeBeacon":
+        return cls._make(cls.FORMAT.unpack(bytes(data[:cls.SIZE])))
+
+
+class GatewayTime(namedtuple("GatewayTime", "version sequence epoch_seconds fractions256 tag")):
+    FORMAT = struct.Struct("<BIIBQ")
+    SIZE = 18
+
+    def pack(self) -> bytes:
+        return self.FORMAT.pack(*self)
+
+    @classmethod
+    def unpack(cls, data: bytes) -> "GatewayTime":
+        return cls._make(cls.FORMAT.unpack(bytes(data[:cls.SIZE])))
+
+
+class Diagnostics(namedtuple("Diagnostics", "version flags uptime_seconds time_writes_accepted time_writes_rejected notifications_sent connects disconnects advertising_starts advertising_failures scheduler_overruns log_dropped ble_events_dropped gateway_times_accepted fast_phase_connections fast_phase_seconds medium_phase_connections medium_phase_seconds slow_phase_connections slow_phase_seconds update_time_calls update_time_max_micros update_time_histogram write_time_calls write_time_max_micros write_time_histogram time_written_calls time_written_max_micros time_written_histogram transport_poll_calls transport_poll_max_micros transport_poll_histogram")):
+    FORMAT = struct.Struct("<BBIIIIIIIIIIIIIIIIIIIHQIHQIHQIHQ")
+    SIZE = 130
+
+    def pack(self) -> bytes:
+        return self.FORMAT.pack(*self)
+
+    @classmethod
+    def unpack(cls, data: bytes) -> "Diagnostics":
+        return cls._make(cls.FORMAT.unpack(bytes(data[:cls.SIZE])))
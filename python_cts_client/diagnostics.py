@@ -0,0 +1,117 @@
+"""讀取手錶的診斷特徵值（自訂服務，格式見 include/CtsSchema.h 的 CtsDiagnostics）。
+
+每支手錶只需連線讀取一次，即可取得開機以來的計數器與熱路徑延遲分佈：
+    python diagnostics.py AA:BB:CC:DD:EE:FF [11:22:33:44:55:66 ...]
+    python diagnostics.py --hex 0101...          # 解碼已擷取的特徵值
+延遲欄位只有在韌體以 CTS_PROFILER=1 建置時才有資料（flags 會標示）。
+"""
+import argparse
+import asyncio
+import sys
+
+from cts_structs import Diagnostics
+
+DIAGNOSTICS_CHAR_UUID = "7d3e0002-5c1a-4b8e-9f2d-3a6c0e5b7f10"
+DIAGNOSTICS_VERSION = 1
+
+# flags 位元（與 src/main.cpp 的 DIAGNOSTICS_* 相同）
+FLAG_NAMES = [(0x01, "synced"), (0x02, "profiler"), (0x04, "ble_thread"), (0x08, "gateway_time")]
+
+# 直方圖八個位元組各自的區間（微秒），每格為該區間呼叫次數佔比（滿分 255）
+HISTOGRAM_BUCKETS = ["<1", "1-4", "4-16", "16-64", "64-256", "256-1k", "1k-4k", ">=4k"]
+
+# (欄位前綴, 顯示名稱)，順序同韌體 Profiler.h 的 PROFILE_PROBES
+PROBES = [
+    ("update_time", "updateInternalTime"),
+    ("write_time", "writeCurrentTime"),
+    ("time_written", "currentTimeWrittenHandler"),
+    ("transport_poll", "transportPoll"),
+]
+
+# (欄位前綴, 顯示名稱)，順序同韌體 AdvertisingScheduler.h 的 ADVERTISING_PHASES
+PHASES = [
+    ("fast_phase", "fast (30ms)"),
+    ("medium_phase", "medium (100ms)"),
+    ("slow_phase", "slow (1022.5ms)"),
+]
+
+COUNTERS = [
+    "uptime_seconds", "time_writes_accepted", "time_writes_rejected", "notifications_sent",
+    "connects", "disconnects", "advertising_starts", "advertising_failures",
+    "scheduler_overruns", "log_dropped", "ble_events_dropped", "gateway_times_accepted",
+]
+
+
+def unpack_histogram(packed: int) -> list:
+    """64 位元直方圖拆成八個百分比，最低位元組為最短的區間。"""
+    return [((packed >> (8 * i)) & 0xFF) * 100 / 255 for i in range(len(HISTOGRAM_BUCKETS))]
+
+
+def format_diagnostics(diagnostics: Diagnostics) -> str:
+    """把一筆診斷資料整理成多行文字。"""
+    if diagnostics.version != DIAGNOSTICS_VERSION:
+        return "不支援的診斷資料版本：%d" % diagnostics.version
+    flags = [name for bit, name in FLAG_NAMES if diagnostics.flags & bit]
+    lines = ["flags: %s" % (", ".join(flags) or "-")]
+    for name in COUNTERS:
+        lines.append("  %-24s %10d" % (name, getattr(diagnostics, name)))
+    lines.append("  %-24s %10s %10s" % ("advertising phase", "links", "seconds"))
+    for prefix, label in PHASES:
+        lines.append("  %-24s %10d %10d" % (label, getattr(diagnostics, prefix + "_connections"),
+                                           getattr(diagnostics, prefix + "_seconds")))
+    if diagnostics.flags & 0x02:
+        lines.append("  %-26s %10s %8s  %s" % ("probe", "calls", "max us", "  ".join(HISTOGRAM_BUCKETS)))
+        for prefix, label in PROBES:
+            calls = getattr(diagnostics, prefix + "_calls")
+            if not calls:
+                continue
+            shares = unpack_histogram(getattr(diagnostics, prefix + "_histogram"))
+            lines.append("  %-26s %10d %8d  %s" % (label, calls, getattr(diagnostics, prefix + "_max_micros"),
+                                                   "  ".join(("%.0f%%" % share).rjust(len(bucket))
+                                                             for share, bucket in zip(shares, HISTOGRAM_BUCKETS))))
+    return "\n".join(lines)
+
+
+async def read_diagnostics(address: str):
+    """連線到一支手錶讀取診斷特徵值，失敗時回傳 None。"""
+    from bleak import BleakClient
+    try:
+        async with BleakClient(address) as client:
+            data = await client.read_gatt_char(DIAGNOSTICS_CHAR_UUID)
+    except Exception as e:
+        print("%s 讀取失敗：%s" % (address, e))
+        return None
+    if len(data) < Diagnostics.SIZE:
+        print("%s 回傳長度 %d，預期 %d" % (address, len(data), Diagnostics.SIZE))
+        return None
+    return Diagnostics.unpack(data)
+
+
+async def scrape(addresses):
+    for address in addresses:
+        diagnostics = await read_diagnostics(address)
+        if diagnostics is not None:
+            print(address)
+            print(format_diagnostics(diagnostics))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="讀取手錶的診斷計數器與延遲分佈")
+    parser.add_argument("addresses", nargs="*", help="手錶的 BLE 位址")
+    parser.add_argument("--hex", help="直接解碼十六進位的特徵值內容，不連線")
+    args = parser.parse_args()
+
+    if args.hex:
+        data = bytes.fromhex(args.hex)
+        if len(data) < Diagnostics.SIZE:
+            print("長度 %d，預期 %d" % (len(data), Diagnostics.SIZE))
+            sys.exit(1)
+        print(format_diagnostics(Diagnostics.unpack(data)))
+        return
+    if not args.addresses:
+        parser.error("請指定至少一個位址，或使用 --hex")
+    asyncio.run(scrape(args.addresses))
+
+
+if __name__ == "__main__":
+    main()
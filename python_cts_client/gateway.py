@@ -0,0 +1,112 @@
+"""本地時間閘道（替身）：以簽章廣播發送時間，讓手錶不必連線即可校時。
+
+每個廣播封包的 manufacturer data 為：
+    [公司 ID (2)][GatewayTime（格式見 include/CtsSchema.h）]
+其中 tag 為以共用金鑰對前面所有位元組計算的 SipHash-2-4，
+sequence 每換一個時間戳記就加一，手錶據此丟棄重送與重播的封包。
+
+目前只有模擬傳輸：依參考時間排程產生封包，逐行輸出給原生模擬
+（lib/NativeSim 的 --gateway 模式從標準輸入讀取）：
+    python gateway.py --sim --hours 48 | program --gateway --days 2 --drift-ppm 40
+真正的閘道只需另外實作同樣有 send() 的傳輸類別，把資料放進廣播即可。
+"""
+import argparse
+import sys
+
+from cts_structs import GatewayTime
+
+GATEWAY_TIME_COMPANY_ID = 0xFFFF
+GATEWAY_TIME_VERSION = 1
+DEFAULT_KEY = bytes(range(16))         # 與韌體 GATEWAY_TIME_KEY 的開發用預設值相同
+DEFAULT_ADDRESS = "5a:7e:00:00:00:01"
+SIM_BOOT_EPOCH = 1748736000            # 原生模擬開機時的參考時間（2025-06-01 00:00:00）
+
+MASK64 = (1 << 64) - 1
+
+
+def _rotl(x, b):
+    return ((x << b) | (x >> (64 - b))) & MASK64
+
+
+def siphash24(key: bytes, data: bytes) -> int:
+    """SipHash-2-4，回傳 64 位元整數（與 include/SipHash.h 相同）。"""
+    k0 = int.from_bytes(key[:8], "little")
+    k1 = int.from_bytes(key[8:16], "little")
+    v = [k0 ^ 0x736f6d6570736575, k1 ^ 0x646f72616e646f6d,
+         k0 ^ 0x6c7967656e657261, k1 ^ 0x7465646279746573]
+
+    def sip_round():
+        v[0] = (v[0] + v[1]) & MASK64; v[1] = _rotl(v[1], 13) ^ v[0]; v[0] = _rotl(v[0], 32)
+        v[2] = (v[2] + v[3]) & MASK64; v[3] = _rotl(v[3], 16) ^ v[2]
+        v[0] = (v[0] + v[3]) & MASK64; v[3] = _rotl(v[3], 21) ^ v[0]
+        v[2] = (v[2] + v[1]) & MASK64; v[1] = _rotl(v[1], 17) ^ v[2]; v[2] = _rotl(v[2], 32)
+
+    def compress(m):
+        v[3] ^= m
+        sip_round()
+        sip_round()
+        v[0] ^= m
+
+    end = len(data) - len(data) % 8
+    for i in range(0, end, 8):
+        compress(int.from_bytes(data[i:i + 8], "little"))
+    compress(int.from_bytes(data[end:], "little") | (len(data) & 0xFF) << 56)
+    v[2] ^= 0xFF
+    for _ in range(4):
+        sip_round()
+    return v[0] ^ v[1] ^ v[2] ^ v[3]
+
+
+def build_gateway_time(key: bytes, sequence: int, epoch_ms: int) -> bytes:
+    """產生一個已簽章的廣播 manufacturer data。"""
+    packet = GatewayTime(GATEWAY_TIME_VERSION, sequence, epoch_ms // 1000,
+                         (epoch_ms % 1000) * 256 // 1000, 0)
+    signed = GATEWAY_TIME_COMPANY_ID.to_bytes(2, "little") + packet.pack()[:-8]
+    return signed + siphash24(key, signed).to_bytes(8, "little")
+
+
+class SimTransport:
+    """模擬傳輸：每個封包輸出一行「參考時間 (ms) 位址 資料十六進位」。"""
+
+    def __init__(self, stream, address):
+        self.stream = stream
+        self.address = address
+
+    def send(self, epoch_ms: int, manufacturer_data: bytes):
+        self.stream.write("%d %s %s\n" % (epoch_ms, self.address, manufacturer_data.hex()))
+
+
+def run_gateway(transport, key, start_ms, duration_ms, interval_ms, sequence):
+    """每 interval_ms 發送一次當下的時間；每個時間戳記使用新的 sequence。"""
+    for epoch_ms in range(start_ms, start_ms + duration_ms, interval_ms):
+        transport.send(epoch_ms, build_gateway_time(key, sequence, epoch_ms))
+        sequence = (sequence + 1) & 0xFFFFFFFF
+
+
+def main():
+    parser = argparse.ArgumentParser(description="本地時間閘道（替身）")
+    parser.add_argument("--sim", action="store_true", required=True,
+                        help="使用模擬傳輸，輸出給原生模擬的 --gateway 模式")
+    parser.add_argument("--start", type=int, default=SIM_BOOT_EPOCH, help="開始時間（epoch 秒）")
+    parser.add_argument("--hours", type=float, default=48, help="發送多少小時")
+    parser.add_argument("--interval-ms", type=int, default=1000, help="廣播間隔")
+    parser.add_argument("--sequence", type=int, default=1, help="第一個封包的 sequence")
+    parser.add_argument("--key", default=DEFAULT_KEY.hex(), help="16 位元組共用金鑰（十六進位）")
+    parser.add_argument("--address", default=DEFAULT_ADDRESS)
+    args = parser.parse_args()
+
+    key = bytes.fromhex(args.key)
+    if len(key) != 16:
+        parser.error("金鑰必須是 16 位元組")
+    transport = SimTransport(sys.stdout, args.address)
+    try:
+        run_gateway(transport, key, args.start * 1000, int(args.hours * 3600000),
+                    args.interval_ms, args.sequence)
+        sys.stdout.flush()
+    except BrokenPipeError:
+        # 模擬已結束、不再讀取
+        sys.stderr.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,103 @@
+"""由 include/CtsSchema.h 產生 cts_structs.py。
+
+韌體端的 CtsCodec.h 與 Python 端的封包定義都來自同一份結構描述，
+修改 CtsSchema.h 後重新執行本程式即可讓兩邊保持一致：
+    python gen_cts_structs.py            # 寫入 cts_structs.py
+    python gen_cts_structs.py --check    # 檢查 cts_structs.py 是否為最新
+"""
+import argparse
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_SCHEMA = os.path.join(HERE, "..", "include", "CtsSchema.h")
+DEFAULT_OUTPUT = os.path.join(HERE, "cts_structs.py")
+
+# C 型別對應的 struct 格式字元
+TYPE_CODES = {
+    "int8_t": "b", "uint8_t": "B",
+    "int16_t": "h", "uint16_t": "H",
+    "int32_t": "i", "uint32_t": "I",
+    "int64_t": "q", "uint64_t": "Q",
+}
+TYPE_SIZES = {"b": 1, "B": 1, "h": 2, "H": 2, "i": 4, "I": 4, "q": 8, "Q": 8}
+
+FIELD_LIST_PATTERN = re.compile(r"#define\s+(\w+)\(X\)((?:[^\n]*\\\n)*[^\n]*)")
+FIELD_PATTERN = re.compile(r"X\(\s*(\w+)\s*,\s*(\w+)\s*\)")
+PACKET_PATTERN = re.compile(r"P\(\s*(\w+)\s*,\s*(\w+)\s*,\s*(\d+)\s*\)")
+
+
+def snake_case(name):
+    """dayOfWeek -> day_of_week"""
+    return re.sub(r"(?<=[a-z0-9])([A-Z])", r"_\1", name).lower()
+
+
+def parse_schema(path):
+    """回傳 [(封包名稱, [(型別代碼, 欄位名稱), ...], 位元組數), ...]。"""
+    with open(path, "r", encoding="utf-8") as f:
+        text = f.read()
+    field_lists = {}
+    for match in FIELD_LIST_PATTERN.finditer(text):
+        field_lists[match.group(1)] = [(TYPE_CODES[t], snake_case(n))
+                                       for t, n in FIELD_PATTERN.findall(match.group(2))]
+    packets_match = re.search(r"#define\s+CTS_PACKETS\(P\)((?:[^\n]*\\\n)*[^\n]*)", text)
+    packets = []
+    for name, fields_macro, size in PACKET_PATTERN.findall(packets_match.group(1)):
+        fields = field_lists[fields_macro]
+        if sum(TYPE_SIZES[code] for code, _ in fields) != int(size):
+            raise ValueError("%s 的欄位長度與宣告的 %s 位元組不符" % (name, size))
+        packets.append((name, fields, int(size)))
+    return packets
+
+
+def generate(packets):
+    """產生 cts_structs.py 的內容。"""
+    lines = [
+        '"""CTS 封包定義（由 gen_cts_structs.py 依 include/CtsSchema.h 產生，請勿手動修改）。"""',
+        "import struct",
+        "from collections import namedtuple",
+        "",
+    ]
+    for name, fields, size in packets:
+        python_name = name[len("Cts"):] if name.startswith("Cts") else name
+        fmt = "<" + "".join(code for code, _ in fields)
+        field_names = " ".join(field for _, field in fields)
+        lines += [
+            "",
+            "class %s(namedtuple(\"%s\", \"%s\")):" % (python_name, python_name, field_names),
+            "    FORMAT = struct.Struct(\"%s\")" % fmt,
+            "    SIZE = %d" % size,
+            "",
+            "    def pack(self) -> bytes:",
+            "        return self.FORMAT.pack(*self)",
+            "",
+            "    @classmethod",
+            "    def unpack(cls, data: bytes) -> \"%s\":" % python_name,
+            "        return cls._make(cls.FORMAT.unpack(bytes(data[:cls.SIZE])))",
+            "",
+        ]
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="由 CtsSchema.h 產生 cts_structs.py")
+    parser.add_argument("--schema", default=DEFAULT_SCHEMA)
+    parser.add_argument("--output", default=DEFAULT_OUTPUT)
+    parser.add_argument("--check", action="store_true", help="只檢查輸出檔是否為最新")
+    args = parser.parse_args()
+
+    content = generate(parse_schema(args.schema))
+    if args.check:
+        with open(args.output, "r", encoding="utf-8") as f:
+            if f.read() != content:
+                print("%s 已過期，請重新執行 gen_cts_structs.py" % args.output)
+                sys.exit(1)
+        return
+    with open(args.output, "w", encoding="utf-8") as f:
+        f.write(content)
+    print("已產生", args.output)
+
+
+if __name__ == "__main__":
+    main()
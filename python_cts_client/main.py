@@ -1,9 +1,10 @@
 import asyncio
+import calendar
 import json
 import os
-import struct
 from datetime import datetime
 from bleak import BleakScanner, BleakClient
+from cts_structs import CurrentTime, TimeBeacon
 
 # CTS 服務與特徵值 UUID（依照 BLE CTS 定義）
 CTS_SERVICE_UUID = "00001805-0000-1000-8000-00805f9b34fb"
@@ -14,9 +15,20 @@ CONFIG_FILE = "config.json"
 DEFAULT_CONFIG = {
     "last_device": None,    # 格式：{"name": <裝置名稱>, "address": <位址>}
     "scan_interval": 300,     # 掃描間隔秒數 (預設 300 秒 = 5 分鐘)
-    "sync_interval": 1800     # 校時間隔秒數 (預設 1800 秒 = 30 分鐘)
+    "sync_interval": 1800,    # 校時間隔秒數 (預設 1800 秒 = 30 分鐘)
+    "max_error_ms": 500       # 廣播中的時間誤差估計低於此值時略過校時
 }
 
+# 韌體廣播的時間信標（manufacturer data，格式見 include/CtsSchema.h）
+TIME_BEACON_COMPANY_ID = 0xFFFF
+TIME_BEACON_VERSION = 1
+TIME_BEACON_REFRESH_S = 10            # 韌體更新信標時間戳記的週期
+TIME_BEACON_NEVER_SYNCED = 0xFFFFFFFF
+TIME_BEACON_ERROR_UNKNOWN = 0xFFFF
+
+# 最近一次掃描收到的時間信標：{位址（小寫）: TimeBeacon}
+latest_beacons = {}
+
 def load_config():
     """讀取設定檔，若不存在則建立預設設定檔。"""
     if os.path.exists(CONFIG_FILE):
@@ -41,50 +53,33 @@ def save_config(config):
 
 def build_current_time_bytes(dt: datetime) -> bytes:
     """
-    將 datetime 依照 BLE CTS 格式打包成 10 個位元組：
-      - Year: 2 個位元組（小端序）
-      - Month: 1 個位元組
-      - Day: 1 個位元組
-      - Hour: 1 個位元組
-      - Minute: 1 個位元組
-      - Second: 1 個位元組
+    將 datetime 依照 BLE CTS 格式打包成 10 個位元組。
+    欄位配置來自 cts_structs.CurrentTime（由 include/CtsSchema.h 產生，與韌體一致）：
+      - Year: 2 個位元組（小端序）、Month、Day、Hour、Minute、Second
       - Day of Week: 1 個位元組（1: 星期一 ~ 7: 星期日）
-      - Fractions256: 1 個位元組（此處固定為 0）
+      - Fractions256: 1 個位元組（1/256 秒，取自 dt.microsecond）
       - Adjust Reason: 1 個位元組（手動更新設為 1）
     """
-    time_bytes = struct.pack(
-        "<HBBBBBBB",
-        dt.year,
-        dt.month,
-        dt.day,
-        dt.hour,
-        dt.minute,
-        dt.second,
-        dt.isoweekday(),
-        0  # fraction256 固定為 0
-    ) + bytes([1])  # adjust_reason 設為 1 (Manual time update)
-    return time_bytes
+    return CurrentTime(
+        year=dt.year,
+        month=dt.month,
+        day=dt.day,
+        hour=dt.hour,
+        minute=dt.minute,
+        second=dt.second,
+        day_of_week=dt.isoweekday(),
+        fractions256=dt.microsecond * 256 // 1000000,  # 次秒相位
+        adjust_reason=1,  # Manual time update
+    ).pack()
 
 def parse_current_time_bytes(data: bytes) -> dict:
     """
     解析 CTS 讀回資料（預期為 10 個位元組），回傳各欄位組成的字典。
     """
-    if len(data) < 10:
+    if len(data) < CurrentTime.SIZE:
         print("回傳資料長度不足：", len(data))
         return {}
-    values = struct.unpack("<HBBBBBBB", data[:9])
-    adjust_reason = data[9]
-    return {
-        "year": values[0],
-        "month": values[1],
-        "day": values[2],
-        "hour": values[3],
-        "minute": values[4],
-        "second": values[5],
-        "day_of_week": values[6],
-        "fraction256": values[7],
-        "adjust_reason": adjust_reason,
-    }
+    return CurrentTime.unpack(data)._asdict()
 
 def choose_device(devices) -> object:
     """
@@ -113,11 +108,18 @@ async def scan_for_device(target_address: str = None) -> object:
     """
     print("開始掃描 BLE 裝置...")
     try:
-        devices = await BleakScanner.discover(timeout=10.0)
+        found = await BleakScanner.discover(timeout=10.0, return_adv=True)
     except Exception as e:
         print("掃描失敗：", e)
         return None
 
+    devices = []
+    for device, advertisement in found.values():
+        devices.append(device)
+        beacon = parse_time_beacon(advertisement)
+        if beacon is not None:
+            latest_beacons[device.address.lower()] = beacon
+
     if target_address:
         # 尋找與 target_address 匹配的裝置
         for device in devices:
@@ -133,6 +135,41 @@ async def scan_for_device(target_address: str = None) -> object:
         print("未發現任何 BLE 裝置。")
         return None
 
+def parse_time_beacon(advertisement):
+    """從廣播資料取出時間信標，沒有或版本不符時回傳 None。"""
+    data = advertisement.manufacturer_data.get(TIME_BEACON_COMPANY_ID)
+    if data is None or len(data) < TimeBeacon.SIZE:
+        return None
+    beacon = TimeBeacon.unpack(data)
+    return beacon if beacon.version == TIME_BEACON_VERSION else None
+
+def sync_needed(address: str, max_error_ms: int) -> bool:
+    """
+    依被動掃描收到的時間信標判斷是否需要連線校時：
+      - 沒有信標、從未校時或誤差無法估計：需要
+      - 信標時間與本機時間相差超過更新週期加上容許誤差：需要（例如裝置重開機）
+      - 韌體估計的累積誤差超過 max_error_ms：需要
+    裝置時間為本地時間（寫入時使用 datetime.now()），因此以 timegm 比較。
+    """
+    beacon = latest_beacons.get(address.lower())
+    if beacon is None:
+        print("未收到時間信標，進行校時。")
+        return True
+    if beacon.seconds_since_sync == TIME_BEACON_NEVER_SYNCED or beacon.error_estimate_ms == TIME_BEACON_ERROR_UNKNOWN:
+        print("裝置尚無足夠的校時紀錄，進行校時。", beacon)
+        return True
+    host_seconds = calendar.timegm(datetime.now().timetuple())
+    stamp_error = host_seconds - beacon.epoch_seconds
+    if not (-max_error_ms / 1000 - 1 <= stamp_error <= TIME_BEACON_REFRESH_S + max_error_ms / 1000 + 1):
+        print(f"信標時間偏差 {stamp_error} 秒，進行校時。")
+        return True
+    if beacon.error_estimate_ms > max_error_ms:
+        print(f"估計誤差 {beacon.error_estimate_ms} ms 超過 {max_error_ms} ms，進行校時。")
+        return True
+    print(f"估計誤差 {beacon.error_estimate_ms} ms（距上次校時 {beacon.seconds_since_sync} 秒，"
+          f"漂移補償 {beacon.drift_ppb} ppb），略過本次校時。")
+    return False
+
 async def calibrate_device(device):
     """
     連線到指定裝置，透過 CTS 寫入目前系統時間後讀回驗證，
@@ -148,7 +185,7 @@ async def calibrate_device(device):
             now = datetime.now()
             time_data = build_current_time_bytes(now)
             # 打印要寫入的 Hex 值
-            print(f"寫入時間：{now.strftime('%Y-%m-%d %H:%M:%S')} (Hex: {time_data.hex().upper()})")
+            print(f"寫入時間：{now.strftime('%Y-%m-%d %H:%M:%S.%f')[:-3]} (Hex: {time_data.hex().upper()})")
             await client.write_gatt_char(CURRENT_TIME_CHAR_UUID, time_data)
             print("時間寫入完成。")
             await asyncio.sleep(1)  # 等待裝置更新
@@ -216,10 +253,12 @@ async def calibration_loop(config: dict):
             print(f"準備對 {device_info.get('name')} 進行校時...")
             # 先確認目標裝置在掃描中是否出現
             device = await scan_for_device(device_info.get("address"))
-            if device:
+            if not device:
+                print("目前掃描中無法找到目標裝置，請透過掃描選擇更新目標裝置。")
+            elif sync_needed(device.address, config.get("max_error_ms", 500)):
                 await calibrate_device(device)
             else:
-                print("目前掃描中無法找到目標裝置，請透過掃描選擇更新目標裝置。")
+                print(f"{device_info.get('name')} 的時間仍在容許誤差內，下次排程再檢查。")
         else:
             print("尚未設定目標裝置，請先透過掃描選擇裝置。")
         await asyncio.sleep(config.get("sync_interval", 1800))
@@ -0,0 +1,187 @@
+"""韌體二進位 trace 解碼工具。
+
+韌體的 Serial 輸出不再是文字，而是一連串訊框：
+    [0xA5][訊息 ID][長度][參數位元組...][檢查碼]
+檢查碼為 ID、長度與參數位元組的 8 位元總和。
+字串表直接由 include/TraceMessages.h 產生，韌體與本工具共用同一份定義。
+
+用法：
+    python trace_decode.py trace.bin
+    python trace_decode.py --port /dev/ttyACM0        # 需要 pyserial
+    program --verbose | python trace_decode.py        # 原生模擬
+    python trace_decode.py --dump-table > table.json  # 匯出字串表
+"""
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+FRAME_SYNC = 0xA5
+
+DEFAULT_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                              "..", "include", "TraceMessages.h")
+
+LEVEL_NAMES = {
+    "LOG_LEVEL_ERROR": "E",
+    "LOG_LEVEL_WARN": "W",
+    "LOG_LEVEL_INFO": "I",
+    "LOG_LEVEL_DEBUG": "D",
+}
+
+# 整數參數的 struct 格式（小端序）
+INTEGER_CODES = {
+    "b": "<b", "B": "<B",
+    "h": "<h", "H": "<H",
+    "i": "<i", "I": "<I",
+    "q": "<q", "Q": "<Q",
+}
+
+ENTRY_PATTERN = re.compile(
+    r'X\(\s*(\d+)\s*,\s*(\w+)\s*,\s*(\w+)\s*,\s*"([^"]*)"\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+
+
+def load_table_from_header(path):
+    """解析 TraceMessages.h，回傳 {id: 訊息描述}。"""
+    with open(path, "r", encoding="utf-8") as f:
+        text = f.read()
+    table = {}
+    for match in ENTRY_PATTERN.finditer(text):
+        message_id, name, level, layout, fmt = match.groups()
+        table[int(message_id)] = {
+            "name": name,
+            "level": LEVEL_NAMES.get(level, "?"),
+            "layout": layout,
+            "format": fmt.encode("utf-8").decode("unicode_escape"),
+        }
+    return table
+
+
+def load_table(args):
+    """依參數讀取 JSON 字串表，或直接解析標頭檔。"""
+    if args.table:
+        with open(args.table, "r", encoding="utf-8") as f:
+            return {int(k): v for k, v in json.load(f).items()}
+    return load_table_from_header(args.header)
+
+
+def decode_arguments(layout, payload):
+    """依 layout 將參數位元組轉為 printf 用的值序列。"""
+    values = []
+    offset = 0
+    for code in layout:
+        if code in INTEGER_CODES:
+            fmt = INTEGER_CODES[code]
+            values.append(struct.unpack_from(fmt, payload, offset)[0])
+            offset += struct.calcsize(fmt)
+        elif code == "T":
+            # DateTime：年 (u16)、月、日、時、分、秒、星期
+            values.extend(struct.unpack_from("<HBBBBBB", payload, offset))
+            offset += 8
+        elif code == "a":
+            # BLE 位址：6 位元組小端序，顯示時最高位元組在前
+            data = payload[offset:offset + 6]
+            if len(data) != 6:
+                raise ValueError("參數長度超出訊框")
+            values.append(":".join("%02x" % b for b in reversed(data)))
+            offset += 6
+        elif code in ("s", "x"):
+            length = payload[offset]
+            data = payload[offset + 1:offset + 1 + length]
+            if len(data) != length:
+                raise ValueError("參數長度超出訊框")
+            offset += 1 + length
+            if code == "s":
+                values.append(data.decode("utf-8", errors="replace"))
+            else:
+                values.append(", ".join("0x%02X" % b for b in data))
+        else:
+            raise ValueError("未知的 layout 代碼：%r" % code)
+    if offset != len(payload):
+        raise ValueError("參數長度與 layout 不符")
+    return tuple(values)
+
+
+def format_message(table, message_id, payload):
+    """將一個訊框轉成文字行。"""
+    entry = table.get(message_id)
+    if entry is None:
+        return "[?] 未知訊息 %d: %s" % (message_id, payload.hex())
+    try:
+        text = entry["format"] % decode_arguments(entry["layout"], payload)
+    except (ValueError, TypeError, struct.error) as e:
+        text = "%s（解碼失敗：%s，原始資料 %s）" % (entry["name"], e, payload.hex())
+    return "[%s] %s" % (entry["level"], text)
+
+
+def iter_frames(read):
+    """從位元組串流中取出訊框；檢查碼錯誤時重新尋找同步位元組。"""
+    buffer = bytearray()
+    while True:
+        chunk = read()
+        if not chunk:
+            break
+        buffer.extend(chunk)
+        while True:
+            start = buffer.find(FRAME_SYNC)
+            if start < 0:
+                buffer.clear()
+                break
+            del buffer[:start]
+            if len(buffer) < 3:
+                break
+            length = buffer[2]
+            frame_size = 4 + length
+            if len(buffer) < frame_size:
+                break
+            checksum = sum(buffer[1:3 + length]) & 0xFF
+            if checksum != buffer[3 + length]:
+                del buffer[:1]  # 不是真正的訊框開頭，往後找
+                continue
+            yield buffer[1], bytes(buffer[3:3 + length])
+            del buffer[:frame_size]
+
+
+def open_reader(args):
+    """回傳讀取函式：序列埠、檔案或標準輸入。"""
+    if args.port:
+        import serial  # pyserial，只有讀取序列埠時才需要
+        port = serial.Serial(args.port, args.baud, timeout=1)
+
+        def read_port():
+            # 逾時回傳空資料時繼續等待，序列埠不會有檔案結尾
+            while True:
+                data = port.read(256)
+                if data:
+                    return data
+        return read_port
+    stream = open(args.input, "rb") if args.input else sys.stdin.buffer
+    return lambda: stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="解碼韌體二進位 trace")
+    parser.add_argument("input", nargs="?", help="trace 檔案（預設為標準輸入）")
+    parser.add_argument("--port", help="序列埠，例如 /dev/ttyACM0 或 COM3")
+    parser.add_argument("--baud", type=int, default=9600)
+    parser.add_argument("--header", default=DEFAULT_HEADER, help="TraceMessages.h 路徑")
+    parser.add_argument("--table", help="改用 --dump-table 匯出的 JSON 字串表")
+    parser.add_argument("--dump-table", action="store_true", help="輸出 JSON 字串表後結束")
+    args = parser.parse_args()
+
+    table = load_table(args)
+    if args.dump_table:
+        json.dump(table, sys.stdout, indent=4, ensure_ascii=False)
+        print()
+        return
+
+    try:
+        for message_id, payload in iter_frames(open_reader(args)):
+            print(format_message(table, message_id, payload), flush=True)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
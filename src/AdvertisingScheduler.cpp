@@ -0,0 +1,107 @@
+#include <string.h>
+#include "AdvertisingScheduler.h"
+#include "Trace.h"
+#include "Transport.h"
+
+struct AdvertisingPhase
+{
+  uint16_t interval; // 0.625ms units
+  uint32_t duration; // ms, 0 = open-ended
+};
+
+static const AdvertisingPhase advertisingPhases[ADV_PHASE_COUNT] = {
+#define ADVERTISING_PHASE_ENTRY(name, interval, duration) {interval, duration},
+    ADVERTISING_PHASES(ADVERTISING_PHASE_ENTRY)
+#undef ADVERTISING_PHASE_ENTRY
+};
+
+AdvertisingScheduler::AdvertisingScheduler()
+    : _active(false),
+      _phase(0),
+      _phaseStartMillis(0)
+{
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+unsigned long AdvertisingScheduler::start(bool burst, unsigned long nowMillis)
+{
+  if (_active)
+  {
+    stopped(false, nowMillis);
+  }
+  return enterPhase(burst ? 0 : ADV_PHASE_COUNT - 1, nowMillis);
+}
+
+unsigned long AdvertisingScheduler::step(unsigned long nowMillis)
+{
+  if (!_active || _phase + 1 >= ADV_PHASE_COUNT)
+  {
+    return 0;
+  }
+  accountPhase(nowMillis);
+  // The interval only takes effect when advertising is (re)started
+  transportStopAdvertise();
+  _active = false;
+  return enterPhase(_phase + 1, nowMillis);
+}
+
+void AdvertisingScheduler::stopped(bool connected, unsigned long nowMillis)
+{
+  if (!_active)
+  {
+    return;
+  }
+  accountPhase(nowMillis);
+  if (connected)
+  {
+    _stats.connections[_phase]++;
+  }
+  _active = false;
+}
+
+void AdvertisingScheduler::refresh()
+{
+  if (!_active)
+  {
+    return; // Picked up by the next start()
+  }
+  // The stack builds the advertising packet in advertise()
+  transportStopAdvertise();
+  if (!transportAdvertise())
+  {
+    _stats.failures++;
+    _active = false;
+  }
+}
+
+unsigned long AdvertisingScheduler::enterPhase(uint8_t phase, unsigned long nowMillis)
+{
+  _phase = phase;
+  _phaseStartMillis = nowMillis;
+  transportSetAdvertisingInterval(advertisingPhases[phase].interval);
+  if (!transportAdvertise())
+  {
+    _stats.failures++;
+    return 0;
+  }
+  _active = true;
+  _stats.starts++;
+  TRACE(ADVERTISING_PHASE, phase, advertisingPhases[phase].interval, _stats.starts);
+  return advertisingPhases[phase].duration;
+}
+
+uint32_t AdvertisingScheduler::millisInPhase(uint8_t phase, unsigned long nowMillis) const
+{
+  uint32_t millis = _stats.millisInPhase[phase];
+  if (_active && phase == _phase)
+  {
+    millis += nowMillis - _phaseStartMillis;
+  }
+  return millis;
+}
+
+void AdvertisingScheduler::accountPhase(unsigned long nowMillis)
+{
+  _stats.millisInPhase[_phase] += nowMillis - _phaseStartMillis;
+  _phaseStartMillis = nowMillis;
+}
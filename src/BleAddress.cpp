@@ -0,0 +1,61 @@
+#include "BleAddress.h"
+
+static int hexDigit(char c)
+{
+  if (c >= '0' && c <= '9')
+  {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f')
+  {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F')
+  {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+bool BleAddress::isNull() const
+{
+  for (uint8_t i = 0; i < BLE_ADDRESS_SIZE; i++)
+  {
+    if (bytes[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+char *BleAddress::format(char text[BLE_ADDRESS_STRING_SIZE]) const
+{
+  static const char digits[] = "0123456789abcdef";
+  for (uint8_t i = 0; i < BLE_ADDRESS_SIZE; i++)
+  {
+    uint8_t value = bytes[BLE_ADDRESS_SIZE - 1 - i];
+    text[i * 3] = digits[value >> 4];
+    text[i * 3 + 1] = digits[value & 0x0F];
+    text[i * 3 + 2] = i + 1 < BLE_ADDRESS_SIZE ? ':' : '\0';
+  }
+  return text;
+}
+
+bool BleAddress::parse(const char *text, BleAddress &address)
+{
+  BleAddress parsed;
+  for (uint8_t i = 0; i < BLE_ADDRESS_SIZE; i++)
+  {
+    int high = hexDigit(text[i * 3]);
+    int low = high < 0 ? -1 : hexDigit(text[i * 3 + 1]);
+    char separator = i + 1 < BLE_ADDRESS_SIZE ? ':' : '\0';
+    if (low < 0 || text[i * 3 + 2] != separator)
+    {
+      return false;
+    }
+    parsed.bytes[BLE_ADDRESS_SIZE - 1 - i] = (high << 4) | low;
+  }
+  address = parsed;
+  return true;
+}
@@ -0,0 +1,80 @@
+#include "ConnectionParams.h"
+#include "Trace.h"
+#include "Transport.h"
+
+static const ConnectionProfile connectionProfiles[CONN_PROFILE_COUNT] = {
+#define CONNECTION_PROFILE_ENTRY(name, minInterval, maxInterval, latency, timeout) {minInterval, maxInterval, latency, timeout},
+    CONNECTION_PROFILES(CONNECTION_PROFILE_ENTRY)
+#undef CONNECTION_PROFILE_ENTRY
+};
+
+ConnectionParams::ConnectionParams(ConnectionTable &connections)
+    : _connections(connections)
+{
+}
+
+const ConnectionProfile &ConnectionParams::profile(ConnectionProfileId id)
+{
+  return connectionProfiles[id < CONN_PROFILE_COUNT ? id : CONN_PROFILE_SYNC];
+}
+
+void ConnectionParams::begin()
+{
+  const ConnectionProfile &sync = profile(CONN_PROFILE_SYNC);
+  transportSetPreferredConnection(sync.minInterval, sync.maxInterval, sync.supervisionTimeout);
+}
+
+void ConnectionParams::onConnected(CentralConnection &connection, unsigned long nowMillis)
+{
+  connection.profile = CONN_PROFILE_SYNC; // Requested by the stack from the preferred parameters
+  connection.lastActivityMillis = nowMillis;
+}
+
+void ConnectionParams::onActivity(const BleAddress &central, unsigned long nowMillis)
+{
+  CentralConnection *connection = _connections.find(central);
+  if (connection)
+  {
+    // Only delays the switch to IDLE; a central's requests are answered at
+    // its next connection event either way, so going back to SYNC would
+    // cost an update procedure for little gain
+    connection->lastActivityMillis = nowMillis;
+  }
+}
+
+unsigned long ConnectionParams::update(unsigned long nowMillis)
+{
+  unsigned long nextIdle = 0;
+  for (uint8_t i = 0; i < MAX_CENTRALS; i++)
+  {
+    CentralConnection &connection = _connections.slot(i);
+    if (!connection.inUse || connection.profile == CONN_PROFILE_IDLE)
+    {
+      continue;
+    }
+    unsigned long quiet = nowMillis - connection.lastActivityMillis;
+    if (quiet >= CONN_IDLE_AFTER_MS)
+    {
+      request(connection, CONN_PROFILE_IDLE);
+      continue;
+    }
+    unsigned long remaining = CONN_IDLE_AFTER_MS - quiet;
+    if (nextIdle == 0 || remaining < nextIdle)
+    {
+      nextIdle = remaining;
+    }
+  }
+  return nextIdle;
+}
+
+bool ConnectionParams::request(CentralConnection &connection, ConnectionProfileId id)
+{
+  const ConnectionProfile &params = profile(id);
+  // The central may reject or adjust the request; the link then keeps its
+  // parameters and we do not retry
+  bool sent = transportUpdateConnection(connection.address, params.minInterval, params.maxInterval,
+                                        params.latency, params.supervisionTimeout);
+  connection.profile = id;
+  TRACE(CONNECTION_PROFILE, connection.address, (uint8_t)id, params.maxInterval, params.latency, (uint8_t)sent);
+  return sent;
+}
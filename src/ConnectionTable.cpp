@@ -0,0 +1,74 @@
+#include "ConnectionTable.h"
+
+ConnectionTable::ConnectionTable()
+    : _count(0),
+      _subscriberCount(0)
+{
+  for (uint8_t i = 0; i < MAX_CENTRALS; i++)
+  {
+    _slots[i].inUse = false;
+    _slots[i].subscribed = false;
+  }
+}
+
+CentralConnection *ConnectionTable::add(const BleAddress &address)
+{
+  for (uint8_t i = 0; i < MAX_CENTRALS; i++)
+  {
+    if (!_slots[i].inUse)
+    {
+      _slots[i].address = address;
+      _slots[i].inUse = true;
+      _slots[i].subscribed = false;
+      _slots[i].profile = 0;
+      _slots[i].lastActivityMillis = 0;
+      _count++;
+      return &_slots[i];
+    }
+  }
+  return NULL;
+}
+
+CentralConnection *ConnectionTable::find(const BleAddress &address)
+{
+  for (uint8_t i = 0; i < MAX_CENTRALS; i++)
+  {
+    if (_slots[i].inUse && _slots[i].address == address)
+    {
+      return &_slots[i];
+    }
+  }
+  return NULL;
+}
+
+bool ConnectionTable::remove(const BleAddress &address)
+{
+  CentralConnection *connection = find(address);
+  if (!connection)
+  {
+    return false;
+  }
+  setSubscribed(address, false);
+  connection->inUse = false;
+  _count--;
+  return true;
+}
+
+bool ConnectionTable::setSubscribed(const BleAddress &address, bool subscribed)
+{
+  CentralConnection *connection = find(address);
+  if (!connection || connection->subscribed == subscribed)
+  {
+    return false;
+  }
+  connection->subscribed = subscribed;
+  if (subscribed)
+  {
+    _subscriberCount++;
+  }
+  else
+  {
+    _subscriberCount--;
+  }
+  return true;
+}
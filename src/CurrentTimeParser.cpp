@@ -0,0 +1,44 @@
+#include "CurrentTimeParser.h"
+#include "Calendar.h"
+#include "CtsCodec.h"
+
+CurrentTimeParseResult parseCurrentTime(const uint8_t *data, size_t length, ParsedCurrentTime &parsed)
+{
+  if (length != CtsCurrentTime::WIRE_SIZE)
+  {
+    return CURRENT_TIME_BAD_LENGTH;
+  }
+
+  CtsCurrentTime::View written(data);
+  uint16_t year = written.year();
+  uint8_t month = written.month();
+  uint8_t day = written.day();
+  if (year < CTS_YEAR_MIN || year > CTS_YEAR_MAX)
+  {
+    return CURRENT_TIME_BAD_YEAR;
+  }
+  // month is checked first so daysInMonth() never indexes past its table
+  if (month < 1 || month > 12 || day < 1 || day > Calendar::daysInMonth(year, month))
+  {
+    return CURRENT_TIME_BAD_DATE;
+  }
+  if (written.hour() > 23 || written.minute() > 59 || written.second() > 59)
+  {
+    return CURRENT_TIME_BAD_TIME;
+  }
+
+  uint32_t days = Calendar::daysFromCivil(year, month, day);
+  uint8_t dayOfWeek = written.dayOfWeek();
+  if (dayOfWeek != 0 && dayOfWeek != Calendar::weekdayFromDays(days))
+  {
+    return CURRENT_TIME_BAD_DAY_OF_WEEK;
+  }
+
+  parsed.epochSeconds = (uint64_t)days * 86400 +
+                        (uint32_t)written.hour() * 3600 +
+                        (uint32_t)written.minute() * 60 +
+                        written.second();
+  parsed.fractions256 = written.fractions256();
+  parsed.adjustReason = written.adjustReason() & CTS_ADJUST_MASK;
+  return CURRENT_TIME_OK;
+}
@@ -0,0 +1,93 @@
+#include "DriftEstimator.h"
+
+DriftEstimator::DriftEstimator()
+{
+  reset();
+}
+
+void DriftEstimator::reset()
+{
+  clearHistory();
+  _correctionPpb = 0;
+  _lastOffsetTicks = 0;
+}
+
+void DriftEstimator::clearHistory()
+{
+  _head = 0;
+  _count = 0;
+}
+
+void DriftEstimator::addSync(uint64_t rawTicks, uint64_t referenceTicks, int64_t offsetTicks)
+{
+  if (_count > 0)
+  {
+    // A jump larger than the worst-case drift since the previous sync means
+    // the time was changed on purpose (first sync, manual set), not drift.
+    // Start a new fit but keep the current correction; the crystal is the same.
+    const Sample &previous = _samples[(_head + DRIFT_HISTORY - 1) % DRIFT_HISTORY];
+    uint64_t span = rawTicks - previous.rawTicks;
+    int64_t tolerance = DRIFT_STEP_TOLERANCE_TICKS + (int64_t)(span / (1000000000ULL / DRIFT_MAX_PPB));
+    int64_t magnitude = offsetTicks < 0 ? -offsetTicks : offsetTicks;
+    if (magnitude > tolerance)
+    {
+      clearHistory();
+    }
+  }
+  _lastOffsetTicks = offsetTicks;
+
+  _samples[_head].rawTicks = rawTicks;
+  _samples[_head].referenceTicks = referenceTicks;
+  _head = (_head + 1) % DRIFT_HISTORY;
+  if (_count < DRIFT_HISTORY)
+  {
+    _count++;
+  }
+  estimate();
+}
+
+// Fit (reference - raw) drift against raw elapsed ticks; the slope is the
+// fractional rate error. Samples are taken relative to the oldest one so the
+// doubles only ever hold spans, not absolute epoch values.
+void DriftEstimator::estimate()
+{
+  if (_count < 2)
+  {
+    return;
+  }
+  const Sample &oldest = _samples[(_head + DRIFT_HISTORY - _count) % DRIFT_HISTORY];
+  const Sample &newest = _samples[(_head + DRIFT_HISTORY - 1) % DRIFT_HISTORY];
+  if (newest.rawTicks - oldest.rawTicks < DRIFT_MIN_SPAN_TICKS)
+  {
+    return;
+  }
+
+  double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    const Sample &sample = _samples[(_head + DRIFT_HISTORY - _count + i) % DRIFT_HISTORY];
+    double x = (double)(sample.rawTicks - oldest.rawTicks);
+    double y = (double)(int64_t)(sample.referenceTicks - oldest.referenceTicks) - x;
+    sumX += x;
+    sumY += y;
+    sumXX += x * x;
+    sumXY += x * y;
+  }
+  double denominator = _count * sumXX - sumX * sumX;
+  if (denominator <= 0)
+  {
+    return;
+  }
+  double slope = (_count * sumXY - sumX * sumY) / denominator;
+
+  double ppb = slope * 1e9;
+  if (ppb > DRIFT_MAX_PPB)
+  {
+    ppb = DRIFT_MAX_PPB;
+  }
+  else if (ppb < -DRIFT_MAX_PPB)
+  {
+    ppb = -DRIFT_MAX_PPB;
+  }
+  _correctionPpb = (int32_t)(ppb < 0 ? ppb - 0.5 : ppb + 0.5);
+}
@@ -0,0 +1,96 @@
+#include "EpochClock.h"
+#include "Calendar.h"
+
+#define SECONDS_PER_DAY 86400UL
+
+EpochClock::EpochClock(uint64_t epochSeconds)
+    : _ticks(epochSeconds * CLOCK_TICKS_PER_SECOND),
+      _rawTicks(0),
+      _lastTimebaseTicks(0),
+      _driftPpb(0),
+      _driftRateQ32(0),
+      _driftResidue(0),
+      _cachedSeconds(0),
+      _cacheValid(false)
+{
+}
+
+void EpochClock::begin(uint32_t nowTicks)
+{
+  _lastTimebaseTicks = nowTicks;
+}
+
+void EpochClock::update(uint32_t nowTicks)
+{
+  // Unsigned subtraction stays correct across the timebase wrap
+  uint32_t elapsed = nowTicks - _lastTimebaseTicks;
+  _lastTimebaseTicks = nowTicks;
+  _rawTicks += elapsed;
+  _ticks += elapsed;
+
+  if (_driftRateQ32 != 0)
+  {
+    // Carry the sub-tick remainder so small corrections are not lost
+    _driftResidue += (int64_t)elapsed * _driftRateQ32;
+    int64_t wholeTicks = _driftResidue >> 32;
+    _driftResidue -= wholeTicks << 32;
+    _ticks += wholeTicks;
+  }
+}
+
+void EpochClock::set(const DateTime &dateTime, uint32_t nowTicks)
+{
+  setTicks(toEpochSeconds(dateTime) * CLOCK_TICKS_PER_SECOND, nowTicks);
+}
+
+void EpochClock::setTicks(uint64_t ticks, uint32_t nowTicks)
+{
+  update(nowTicks); // Keep the raw counter continuous across the jump
+  _ticks = ticks;
+  _driftResidue = 0;
+  _cacheValid = false;
+}
+
+void EpochClock::setDriftCorrectionPpb(int32_t ppb)
+{
+  _driftPpb = ppb;
+  _driftRateQ32 = ((int64_t)ppb << 32) / 1000000000;
+}
+
+const DateTime &EpochClock::dateTime()
+{
+  uint64_t seconds = epochSeconds();
+  if (!_cacheValid || seconds != _cachedSeconds)
+  {
+    _cachedDateTime = fromEpochSeconds(seconds);
+    _cachedSeconds = seconds;
+    _cacheValid = true;
+  }
+  return _cachedDateTime;
+}
+
+uint64_t EpochClock::toEpochSeconds(const DateTime &dateTime)
+{
+  uint32_t days = Calendar::daysFromCivil(dateTime.year, dateTime.month, dateTime.day);
+  return (uint64_t)days * SECONDS_PER_DAY +
+         (uint32_t)dateTime.hour * 3600 +
+         (uint32_t)dateTime.minute * 60 +
+         dateTime.second;
+}
+
+DateTime EpochClock::fromEpochSeconds(uint64_t epochSeconds)
+{
+  DateTime dt;
+  uint32_t days = (uint32_t)(epochSeconds / SECONDS_PER_DAY);
+  uint32_t secondOfDay = (uint32_t)(epochSeconds - (uint64_t)days * SECONDS_PER_DAY);
+
+  Calendar::CivilDate date = Calendar::civilFromDays(days);
+  dt.year = date.year;
+  dt.month = date.month;
+  dt.day = date.day;
+  dt.hour = secondOfDay / 3600;
+  dt.minute = (secondOfDay / 60) % 60;
+  dt.second = secondOfDay % 60;
+  dt.dayOfWeek = Calendar::weekdayFromDays(days);
+  return dt;
+}
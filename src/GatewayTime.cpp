@@ -0,0 +1,43 @@
+#include <string.h>
+#include "GatewayTime.h"
+
+GatewayTimeReceiver::GatewayTimeReceiver(const uint8_t key[SIP_HASH_KEY_SIZE])
+    : _lastSequence(0), _acceptedCount(0)
+{
+  memcpy(_key, key, sizeof(_key));
+}
+
+GatewayTimeResult GatewayTimeReceiver::accept(const uint8_t *manufacturerData, int length, uint64_t localEpochSeconds,
+                                              bool localSynced, ParsedCurrentTime &parsed)
+{
+  if (length != GATEWAY_TIME_LENGTH || ctsLoad<uint16_t>(manufacturerData) != GATEWAY_TIME_COMPANY_ID)
+  {
+    return GATEWAY_TIME_NOT_GATEWAY;
+  }
+  CtsGatewayTime::View broadcast(manufacturerData + 2);
+  if (broadcast.version() != GATEWAY_TIME_VERSION)
+  {
+    return GATEWAY_TIME_NOT_GATEWAY;
+  }
+  if (_acceptedCount && broadcast.sequence() <= _lastSequence)
+  {
+    return GATEWAY_TIME_REPEATED;
+  }
+  uint64_t epochSeconds = broadcast.epochSeconds();
+  uint64_t step = epochSeconds > localEpochSeconds ? epochSeconds - localEpochSeconds : localEpochSeconds - epochSeconds;
+  if (localSynced ? step > GATEWAY_TIME_MAX_STEP_S : epochSeconds < localEpochSeconds)
+  {
+    return GATEWAY_TIME_OUT_OF_WINDOW;
+  }
+  if (sipHash24(_key, manufacturerData, GATEWAY_TIME_SIGNED_LENGTH) != broadcast.tag())
+  {
+    return GATEWAY_TIME_BAD_TAG;
+  }
+
+  _lastSequence = broadcast.sequence();
+  _acceptedCount++;
+  parsed.epochSeconds = epochSeconds;
+  parsed.fractions256 = broadcast.fractions256();
+  parsed.adjustReason = 0;
+  return GATEWAY_TIME_OK;
+}
@@ -0,0 +1,127 @@
+#include <Arduino.h>
+#include <atomic>
+#include "Log.h"
+
+static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0, "LOG_BUFFER_SIZE must be a power of two");
+
+// Record layout in the ring: [id][length][payload...]
+#define LOG_RECORD_HEADER 2
+
+static uint8_t ring[LOG_BUFFER_SIZE];
+static std::atomic<uint16_t> ringHead(0); // Written by the producer only
+static std::atomic<uint16_t> ringTail(0); // Written by the consumer only
+static std::atomic<uint32_t> droppedCount(0);
+static void (*wakeHook)() = NULL;
+
+// Consumer state: the frame currently being written out
+static uint8_t frame[LOG_RECORD_HEADER + LOG_MAX_PAYLOAD + 2];
+static size_t frameLength = 0;
+static size_t framePosition = 0;
+
+static void ringCopyIn(uint16_t position, const void *data, size_t length)
+{
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < length; i++)
+  {
+    ring[(position + i) & (LOG_BUFFER_SIZE - 1)] = bytes[i];
+  }
+}
+
+static void ringCopyOut(uint16_t position, void *data, size_t length)
+{
+  uint8_t *bytes = (uint8_t *)data;
+  for (size_t i = 0; i < length; i++)
+  {
+    bytes[i] = ring[(position + i) & (LOG_BUFFER_SIZE - 1)];
+  }
+}
+
+void logRecord(uint8_t id, const uint8_t *payload, uint8_t length)
+{
+  uint16_t head = ringHead.load(std::memory_order_relaxed);
+  uint16_t tail = ringTail.load(std::memory_order_acquire);
+  size_t used = (uint16_t)(head - tail);
+  if (length > LOG_MAX_PAYLOAD || used + LOG_RECORD_HEADER + length > LOG_BUFFER_SIZE)
+  {
+    droppedCount.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  uint8_t header[LOG_RECORD_HEADER] = {id, length};
+  ringCopyIn(head, header, LOG_RECORD_HEADER);
+  ringCopyIn(head + LOG_RECORD_HEADER, payload, length);
+  ringHead.store(head + LOG_RECORD_HEADER + length, std::memory_order_release);
+
+  if (used == 0 && wakeHook)
+  {
+    wakeHook();
+  }
+}
+
+void logSetWakeHook(void (*hook)())
+{
+  wakeHook = hook;
+}
+
+uint32_t logDroppedCount()
+{
+  return droppedCount.load(std::memory_order_relaxed);
+}
+
+// Pop the next record into frame[]; false if the ring is empty
+static bool logLoadFrame()
+{
+  uint16_t tail = ringTail.load(std::memory_order_relaxed);
+  uint16_t head = ringHead.load(std::memory_order_acquire);
+  if (head == tail)
+  {
+    return false;
+  }
+
+  uint8_t header[LOG_RECORD_HEADER];
+  ringCopyOut(tail, header, LOG_RECORD_HEADER);
+  uint8_t length = header[1];
+
+  frame[0] = LOG_FRAME_SYNC;
+  frame[1] = header[0];
+  frame[2] = length;
+  ringCopyOut(tail + LOG_RECORD_HEADER, frame + 3, length);
+  uint8_t checksum = 0;
+  for (size_t i = 1; i < 3 + (size_t)length; i++)
+  {
+    checksum += frame[i];
+  }
+  frame[3 + length] = checksum;
+  frameLength = 4 + length;
+  framePosition = 0;
+
+  ringTail.store(tail + LOG_RECORD_HEADER + length, std::memory_order_release);
+  return true;
+}
+
+bool logDrain(size_t maxBytes)
+{
+  while (maxBytes > 0)
+  {
+    if (framePosition == frameLength && !logLoadFrame())
+    {
+      return false;
+    }
+    size_t chunk = frameLength - framePosition;
+    if (chunk > maxBytes)
+    {
+      chunk = maxBytes;
+    }
+    Serial.write(frame + framePosition, chunk);
+    framePosition += chunk;
+    maxBytes -= chunk;
+  }
+  return framePosition < frameLength || ringHead.load(std::memory_order_acquire) != ringTail.load(std::memory_order_relaxed);
+}
+
+void logFlush()
+{
+  while (logDrain(sizeof(frame)))
+  {
+  }
+}
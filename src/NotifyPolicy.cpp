@@ -0,0 +1,55 @@
+#include "NotifyPolicy.h"
+
+NotifyPolicy::NotifyPolicy()
+    : _subscribed(false),
+      _pending(false),
+      _pendingReason(CTS_ADJUST_NONE),
+      _lastNotifiedMinute(0)
+{
+}
+
+void NotifyPolicy::setSubscribed(bool subscribed, uint64_t epochSeconds)
+{
+  _subscribed = subscribed;
+  _pendingReason = CTS_ADJUST_NONE;
+  // A new subscriber gets the current value right away
+  _pending = subscribed;
+  _lastNotifiedMinute = epochSeconds / 60;
+}
+
+bool NotifyPolicy::onTimeAdjusted(uint8_t adjustReason, int64_t offsetMillis)
+{
+  if (!_subscribed)
+  {
+    return false;
+  }
+  _pendingReason |= adjustReason & CTS_ADJUST_MASK;
+  int64_t magnitude = offsetMillis < 0 ? -offsetMillis : offsetMillis;
+  if (!(adjustReason & CTS_ADJUST_MANUAL) && magnitude < NOTIFY_SIGNIFICANT_OFFSET_MS)
+  {
+    return false; // Rides on the next minute notification, reason and all
+  }
+  _pending = true;
+  return true;
+}
+
+bool NotifyPolicy::poll(uint64_t epochSeconds, uint8_t &adjustReason)
+{
+  if (!_subscribed)
+  {
+    return false;
+  }
+
+  uint64_t minute = epochSeconds / 60;
+  bool minuteChanged = NOTIFY_ON_MINUTE_CHANGE && minute != _lastNotifiedMinute;
+  if (!_pending && !minuteChanged)
+  {
+    return false;
+  }
+
+  adjustReason = _pendingReason;
+  _pending = false;
+  _pendingReason = CTS_ADJUST_NONE;
+  _lastNotifiedMinute = minute;
+  return true;
+}
@@ -0,0 +1,102 @@
+#include "Profiler.h"
+
+#if CTS_PROFILER
+
+#include <string.h>
+#include "Trace.h"
+
+static ProfileStats probes[PROFILE_PROBE_COUNT];
+
+static const char *const probeLabels[PROFILE_PROBE_COUNT] = {
+#define PROFILE_PROBE_LABEL(name, label) label,
+    PROFILE_PROBES(PROFILE_PROBE_LABEL)
+#undef PROFILE_PROBE_LABEL
+};
+
+void profilerBegin()
+{
+#if !defined(CTS_NATIVE_SIM)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+  profileReset();
+}
+
+void profileRecord(ProfileProbeId probe, uint32_t ticks)
+{
+  ProfileStats &stats = probes[probe];
+  stats.minTicks = stats.count == 0 || ticks < stats.minTicks ? ticks : stats.minTicks;
+  stats.maxTicks = ticks > stats.maxTicks ? ticks : stats.maxTicks;
+  stats.count++;
+  stats.totalTicks += ticks;
+  uint8_t bucket = ticks ? 32 - __builtin_clz(ticks) : 0; // Bits needed for ticks
+  stats.histogram[bucket < PROFILE_HISTOGRAM_BUCKETS ? bucket : PROFILE_HISTOGRAM_BUCKETS - 1]++;
+}
+
+const ProfileStats &profileStats(ProfileProbeId probe)
+{
+  return probes[probe];
+}
+
+const char *profileProbeLabel(ProfileProbeId probe)
+{
+  return probeLabels[probe];
+}
+
+uint32_t profileTicksToNanos(uint64_t ticks)
+{
+  uint64_t nanos = ticks * 1000 / PROFILER_TICKS_PER_MICROSECOND;
+  return nanos < 0xFFFFFFFFULL ? nanos : 0xFFFFFFFFUL;
+}
+
+// Each log2 tick bucket goes where its lower bound falls: bucket 0 below
+// 1 us, then one per factor of 4 up to the open-ended last one
+uint64_t profilePackedHistogram(ProfileProbeId probe)
+{
+  const ProfileStats &stats = probes[probe];
+  if (!stats.count)
+  {
+    return 0;
+  }
+  uint32_t packed[PROFILE_PACKED_BUCKETS] = {};
+  for (uint8_t bucket = 0; bucket < PROFILE_HISTOGRAM_BUCKETS; bucket++)
+  {
+    uint32_t micros = (bucket ? 1UL << (bucket - 1) : 0) / PROFILER_TICKS_PER_MICROSECOND;
+    uint8_t index = micros ? 1 + (31 - __builtin_clz(micros)) / 2 : 0;
+    packed[index < PROFILE_PACKED_BUCKETS ? index : PROFILE_PACKED_BUCKETS - 1] += stats.histogram[bucket];
+  }
+  uint64_t shares = 0;
+  for (uint8_t index = 0; index < PROFILE_PACKED_BUCKETS; index++)
+  {
+    uint64_t share = ((uint64_t)packed[index] * 255 + stats.count / 2) / stats.count;
+    shares |= share << (8 * index);
+  }
+  return shares;
+}
+
+uint16_t profileMaxMicros(ProfileProbeId probe)
+{
+  uint32_t micros = probes[probe].maxTicks / PROFILER_TICKS_PER_MICROSECOND;
+  return micros < 0xFFFF ? micros : 0xFFFF;
+}
+
+void profileReset()
+{
+  memset(probes, 0, sizeof(probes));
+}
+
+void profileReport()
+{
+  for (uint8_t i = 0; i < PROFILE_PROBE_COUNT; i++)
+  {
+    const ProfileStats &stats = probes[i];
+    if (stats.count)
+    {
+      TRACE(PROFILE_SUMMARY, TraceString{probeLabels[i]}, stats.count, profileTicksToNanos(stats.minTicks),
+            profileTicksToNanos(stats.totalTicks / stats.count), profileTicksToNanos(stats.maxTicks));
+    }
+  }
+}
+
+#endif
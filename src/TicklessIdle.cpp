@@ -0,0 +1,34 @@
+#include "TicklessIdle.h"
+#include "Transport.h"
+
+TicklessIdle::TicklessIdle(Scheduler &scheduler, Task *const *tasks, uint8_t taskCount, unsigned long maxSleepMillis)
+    : _scheduler(scheduler),
+      _tasks(tasks),
+      _taskCount(taskCount),
+      _maxSleepMillis(maxSleepMillis)
+{
+}
+
+unsigned long TicklessIdle::nextDeadline()
+{
+  unsigned long deadline = _maxSleepMillis;
+  for (uint8_t i = 0; i < _taskCount; i++)
+  {
+    long untilNext = _scheduler.timeUntilNextIteration(*_tasks[i]);
+    if (untilNext < 0)
+    {
+      continue; // Task disabled
+    }
+    if ((unsigned long)untilNext < deadline)
+    {
+      deadline = untilNext;
+    }
+  }
+  return deadline;
+}
+
+void TicklessIdle::sleep()
+{
+  // Returns early as soon as the BLE stack has an event to process
+  transportPoll(nextDeadline());
+}
@@ -0,0 +1,33 @@
+#include "TimeBeacon.h"
+#include "Timebase.h"
+
+TimeBeacon::TimeBeacon()
+{
+  ctsStore<uint16_t>(_data, TIME_BEACON_COMPANY_ID);
+  update(0, false, 0, 0, 0, 0);
+}
+
+void TimeBeacon::update(uint64_t epochSeconds, bool synced, uint64_t sinceSyncTicks,
+                        uint64_t lastSpanTicks, int64_t lastOffsetTicks, int32_t driftPpb)
+{
+  uint64_t sinceSyncSeconds = sinceSyncTicks / TIMEBASE_TICKS_PER_SECOND;
+  CtsTimeBeacon beacon = {TIME_BEACON_VERSION,
+                          (uint32_t)epochSeconds,
+                          synced ? (uint32_t)(sinceSyncSeconds < TIME_BEACON_NEVER_SYNCED ? sinceSyncSeconds : TIME_BEACON_NEVER_SYNCED - 1)
+                                 : TIME_BEACON_NEVER_SYNCED,
+                          driftPpb,
+                          synced ? errorEstimateMs(sinceSyncTicks, lastSpanTicks, lastOffsetTicks)
+                                 : (uint16_t)TIME_BEACON_ERROR_UNKNOWN};
+  beacon.encode(_data + 2);
+}
+
+uint16_t TimeBeacon::errorEstimateMs(uint64_t sinceSyncTicks, uint64_t lastSpanTicks, int64_t lastOffsetTicks)
+{
+  if (lastSpanTicks == 0)
+  {
+    return TIME_BEACON_ERROR_UNKNOWN;
+  }
+  double offsetMs = (double)(lastOffsetTicks < 0 ? -lastOffsetTicks : lastOffsetTicks) * 1000.0 / TIMEBASE_TICKS_PER_SECOND;
+  double estimate = offsetMs * (double)sinceSyncTicks / (double)lastSpanTicks;
+  return estimate < TIME_BEACON_ERROR_UNKNOWN - 1 ? (uint16_t)estimate : TIME_BEACON_ERROR_UNKNOWN - 1;
+}
@@ -0,0 +1,16 @@
+#include "Timebase.h"
+
+#if CTS_TIMEBASE == TIMEBASE_MILLIS
+
+#include <Arduino.h>
+
+void timebaseBegin()
+{
+}
+
+uint32_t timebaseNow()
+{
+  return millis();
+}
+
+#endif
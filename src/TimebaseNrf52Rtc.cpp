@@ -0,0 +1,82 @@
+#include "Timebase.h"
+
+// The native build substitutes a simulated RTC (lib/NativeSim)
+#if CTS_TIMEBASE == TIMEBASE_NRF52_RTC && !defined(CTS_NATIVE_SIM)
+
+#include <Arduino.h>
+
+// RTC2 is unused by the mbed core (lp_ticker runs on RTC1) and by Cordio.
+// With PRESCALER = 0 the 24-bit COUNTER ticks at 32.768 kHz and overflows
+// every 512 s; the overflow interrupt extends it to 32 bits in software.
+#define TIMEBASE_RTC NRF_RTC2
+#define TIMEBASE_RTC_IRQn RTC2_IRQn
+#define RTC_COUNTER_BITS 24
+
+static volatile uint32_t overflowCount = 0;
+static bool started = false;
+
+static void timebaseRtcIrqHandler()
+{
+  if (TIMEBASE_RTC->EVENTS_OVRFLW)
+  {
+    TIMEBASE_RTC->EVENTS_OVRFLW = 0;
+    (void)TIMEBASE_RTC->EVENTS_OVRFLW; // Flush the write before leaving the ISR
+    overflowCount++;
+  }
+}
+
+void timebaseBegin()
+{
+  if (started)
+  {
+    return;
+  }
+  started = true;
+
+  // The LFCLK is normally already running for the lp_ticker and the radio
+  if (!(NRF_CLOCK->LFCLKSTAT & CLOCK_LFCLKSTAT_STATE_Msk))
+  {
+    NRF_CLOCK->LFCLKSRC = CLOCK_LFCLKSRC_SRC_Xtal << CLOCK_LFCLKSRC_SRC_Pos;
+    NRF_CLOCK->EVENTS_LFCLKSTARTED = 0;
+    NRF_CLOCK->TASKS_LFCLKSTART = 1;
+    while (!NRF_CLOCK->EVENTS_LFCLKSTARTED)
+    {
+    }
+  }
+
+  TIMEBASE_RTC->TASKS_STOP = 1;
+  TIMEBASE_RTC->TASKS_CLEAR = 1;
+  TIMEBASE_RTC->PRESCALER = 0;
+  TIMEBASE_RTC->EVENTS_OVRFLW = 0;
+  TIMEBASE_RTC->EVTENSET = RTC_EVTENSET_OVRFLW_Msk;
+  TIMEBASE_RTC->INTENSET = RTC_INTENSET_OVRFLW_Msk;
+
+  NVIC_SetVector(TIMEBASE_RTC_IRQn, (uint32_t)&timebaseRtcIrqHandler);
+  NVIC_SetPriority(TIMEBASE_RTC_IRQn, 7); // Lowest; only has to beat a 512 s deadline
+  NVIC_ClearPendingIRQ(TIMEBASE_RTC_IRQn);
+  NVIC_EnableIRQ(TIMEBASE_RTC_IRQn);
+
+  TIMEBASE_RTC->TASKS_START = 1;
+}
+
+uint32_t timebaseNow()
+{
+  uint32_t sampled;
+  uint32_t overflows;
+  uint32_t counter;
+  do
+  {
+    sampled = overflowCount;
+    counter = TIMEBASE_RTC->COUNTER;
+    overflows = sampled;
+    // Overflow happened but its interrupt has not run yet (e.g. we are in a
+    // higher-priority context): a small counter value belongs to the next lap
+    if (TIMEBASE_RTC->EVENTS_OVRFLW && counter < (1UL << (RTC_COUNTER_BITS - 1)))
+    {
+      overflows++;
+    }
+  } while (sampled != overflowCount); // The interrupt ran in between: sample again
+  return (overflows << RTC_COUNTER_BITS) | counter;
+}
+
+#endif
@@ -0,0 +1,411 @@
+#include "Transport.h"
+
+#if CTS_TRANSPORT == TRANSPORT_ARDUINO_BLE
+
+#include <utility/ATT.h>
+#include <utility/HCI.h>
+#include <utility/HCITransport.h>
+#include "Profiler.h"
+#if CTS_BLE_THREAD
+#include <atomic>
+#include <mbed.h>
+#endif
+
+static_assert(GATT_READ == BLERead && GATT_WRITE == BLEWrite && GATT_NOTIFY == BLENotify,
+              "GattTable.h properties are passed to ArduinoBLE as they are");
+
+static BLEService services[GATT_SERVICE_COUNT] = {
+#define GATT_SERVICE_OBJECT(name, uuid) BLEService(uuid),
+    GATT_SERVICES(GATT_SERVICE_OBJECT)
+#undef GATT_SERVICE_OBJECT
+};
+
+static BLECharacteristic characteristics[GATT_CHARACTERISTIC_COUNT] = {
+#define GATT_CHARACTERISTIC_OBJECT(name, service, uuid, properties, size) BLECharacteristic(uuid, properties, size),
+    GATT_CHARACTERISTICS(GATT_CHARACTERISTIC_OBJECT)
+#undef GATT_CHARACTERISTIC_OBJECT
+};
+
+static TransportCharacteristicHandler characteristicHandlers[GATT_CHARACTERISTIC_COUNT][TRANSPORT_CHARACTERISTIC_EVENT_COUNT];
+static TransportPeerHandler peerHandlers[TRANSPORT_PEER_EVENT_COUNT];
+
+// ArduinoBLE event numbers, by TransportCharacteristicEvent / TransportPeerEvent
+static const int characteristicEvents[TRANSPORT_CHARACTERISTIC_EVENT_COUNT] = {BLEWritten, BLERead, BLESubscribed, BLEUnsubscribed};
+static const BLEDeviceEvent peerEvents[TRANSPORT_PEER_EVENT_COUNT] = {BLEConnected, BLEDisconnected, BLEDiscovered};
+
+// ArduinoBLE keeps a device's address bytes private and only hands them out
+// as text, so this is the one place an event's address is formatted and
+// parsed; everything above the transport works on the 6-byte value
+static TransportPeer toPeer(const BLEDevice &device)
+{
+  BleAddress address = {};
+  BleAddress::parse(device.address().c_str(), address);
+  uint8_t data[TRANSPORT_MANUFACTURER_DATA_SIZE];
+  int length = device.hasManufacturerData() ? device.manufacturerData(data, sizeof(data)) : 0;
+  return TransportPeer(address, data, length);
+}
+
+#if CTS_BLE_THREAD
+// --- BLE thread ---
+// ArduinoBLE is not thread-safe, so every call into it holds the stack lock.
+// The thread sleeps in the HCI transport until the controller has an event,
+// then takes the lock for one BLE.poll(); the application takes it for its
+// own calls and runs them directly, so nothing wakes up on a timer. Stack
+// events are copied into a single-producer/single-consumer ring that
+// transportPoll() drains on the application side; they are produced with
+// the lock held (an HCI command can process events while it waits for its
+// reply), so there is one producer at a time. Read hooks are the exception:
+// the stack answers right after them, so they run in place.
+#define BLE_THREAD_STACK_SIZE 4096
+#define BLE_EVENT_QUEUE_SIZE 16 // Power of two
+
+static_assert((BLE_EVENT_QUEUE_SIZE & (BLE_EVENT_QUEUE_SIZE - 1)) == 0, "BLE_EVENT_QUEUE_SIZE must be a power of two");
+
+enum TransportEventKind : uint8_t
+{
+  PEER_EVENT = 0,
+  CHARACTERISTIC_EVENT
+};
+
+struct TransportEvent
+{
+  TransportEventKind kind;
+  uint8_t event; // TransportPeerEvent or TransportCharacteristicEvent
+  GattCharacteristicId characteristic;
+  uint8_t valueLength; // Written value, captured on the BLE thread
+  uint8_t value[gattMaxValueSize(GATT_WRITE)];
+  TransportPeer peer;
+};
+
+static rtos::Thread bleThread(osPriorityAboveNormal, BLE_THREAD_STACK_SIZE);
+static rtos::Mutex stackLock; // Recursive: a read hook run under it may store a value
+
+static TransportEvent eventQueue[BLE_EVENT_QUEUE_SIZE];
+static std::atomic<uint16_t> eventHead(0); // Written by the BLE thread only
+static std::atomic<uint16_t> eventTail(0); // Written by the application only
+static std::atomic<uint32_t> droppedEvents(0);
+static rtos::Semaphore eventPending(0, 1); // Wakes transportPoll()
+static const TransportEvent *dispatching = NULL; // Event whose handler is running
+
+static void bleThreadMain()
+{
+  while (true)
+  {
+    // Without the lock: the wait only blocks on the transport's receive flag
+    HCITransport.wait(osWaitForever);
+    stackLock.lock();
+    BLE.poll();
+    stackLock.unlock();
+  }
+}
+
+// Runs request in the caller's thread with the stack lock held
+template <typename Request>
+static void withStack(Request request)
+{
+  stackLock.lock();
+  request();
+  stackLock.unlock();
+}
+
+// BLE thread side
+static void postEvent(const TransportEvent &event)
+{
+  uint16_t head = eventHead.load(std::memory_order_relaxed);
+  if ((uint16_t)(head - eventTail.load(std::memory_order_acquire)) == BLE_EVENT_QUEUE_SIZE)
+  {
+    droppedEvents.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  eventQueue[head & (BLE_EVENT_QUEUE_SIZE - 1)] = event;
+  eventHead.store(head + 1, std::memory_order_release);
+  eventPending.release(); // Fails harmlessly if a wake-up is already pending
+}
+
+// Application side
+static void dispatchEvent(const TransportEvent &event)
+{
+  if (event.kind == PEER_EVENT)
+  {
+    if (peerHandlers[event.event])
+    {
+      peerHandlers[event.event](event.peer);
+    }
+    return;
+  }
+  TransportCharacteristicHandler handler = characteristicHandlers[event.characteristic][event.event];
+  if (handler)
+  {
+    dispatching = &event;
+    handler(event.peer, event.characteristic);
+    dispatching = NULL;
+  }
+}
+
+#else
+// Without the BLE thread every caller already is the stack's context
+template <typename Request>
+static void withStack(Request request)
+{
+  request();
+}
+#endif
+
+template <TransportPeerEvent Event>
+static void peerTrampoline(BLEDevice device)
+{
+#if CTS_BLE_THREAD
+  TransportEvent event = {PEER_EVENT, Event, GATT_CHARACTERISTIC_COUNT, 0, {}, toPeer(device)};
+  postEvent(event);
+#else
+  peerHandlers[Event](toPeer(device));
+#endif
+}
+
+static const BLEDeviceEventHandler peerTrampolines[TRANSPORT_PEER_EVENT_COUNT] = {
+    &peerTrampoline<TRANSPORT_CONNECTED>, &peerTrampoline<TRANSPORT_DISCONNECTED>, &peerTrampoline<TRANSPORT_DISCOVERED>};
+
+// ArduinoBLE hands over a BLECharacteristic; one instance per characteristic
+// and event turns that into the table index without a UUID lookup
+template <GattCharacteristicId Id, TransportCharacteristicEvent Event>
+static void characteristicTrampoline(BLEDevice central, BLECharacteristic characteristic)
+{
+#if CTS_BLE_THREAD
+  if (Event != TRANSPORT_READ)
+  {
+    TransportEvent event = {CHARACTERISTIC_EVENT, Event, Id, 0, {}, toPeer(central)};
+    if (Event == TRANSPORT_WRITTEN)
+    {
+      int length = characteristic.valueLength();
+      event.valueLength = length < (int)sizeof(event.value) ? length : sizeof(event.value);
+      memcpy(event.value, characteristic.value(), event.valueLength);
+    }
+    postEvent(event);
+    return;
+  }
+#endif
+  characteristicHandlers[Id][Event](toPeer(central), Id);
+}
+
+static const BLECharacteristicEventHandler trampolines[GATT_CHARACTERISTIC_COUNT][TRANSPORT_CHARACTERISTIC_EVENT_COUNT] = {
+#define GATT_CHARACTERISTIC_TRAMPOLINES(name, service, uuid, properties, size)                                 \
+  {&characteristicTrampoline<GATT_##name, TRANSPORT_WRITTEN>, &characteristicTrampoline<GATT_##name, TRANSPORT_READ>, \
+   &characteristicTrampoline<GATT_##name, TRANSPORT_SUBSCRIBED>, &characteristicTrampoline<GATT_##name, TRANSPORT_UNSUBSCRIBED>},
+    GATT_CHARACTERISTICS(GATT_CHARACTERISTIC_TRAMPOLINES)
+#undef GATT_CHARACTERISTIC_TRAMPOLINES
+};
+
+// The ATT layer knows the link handle, but the address type is not passed
+// up with events: try public, then random
+static uint16_t connectionHandle(const BleAddress &peer)
+{
+  uint16_t handle = ATT.connectionHandle(0x00, peer.bytes);
+  return handle != 0xFFFF ? handle : ATT.connectionHandle(0x01, peer.bytes);
+}
+
+// --- Lifecycle ---
+
+bool transportBegin(const char *deviceName)
+{
+  if (!BLE.begin())
+  {
+    return false;
+  }
+  BLE.setLocalName(deviceName);
+  BLE.setDeviceName(deviceName);
+  for (uint8_t i = 0; i < GATT_CHARACTERISTIC_COUNT; i++)
+  {
+    services[gattCharacteristics[i].service].addCharacteristic(characteristics[i]);
+  }
+  for (uint8_t i = 0; i < GATT_SERVICE_COUNT; i++)
+  {
+    BLE.addService(services[i]);
+  }
+  BLE.setAdvertisedService(services[0]);
+#if CTS_BLE_THREAD
+  return bleThread.start(bleThreadMain) == osOK;
+#else
+  return true;
+#endif
+}
+
+#if CTS_BLE_THREAD
+void transportPoll(unsigned long timeoutMillis)
+{
+  eventPending.try_acquire(); // Consume a wake-up for events drained below
+  uint16_t tail = eventTail.load(std::memory_order_relaxed);
+  if (timeoutMillis && tail == eventHead.load(std::memory_order_acquire))
+  {
+    eventPending.try_acquire_for(std::chrono::milliseconds(timeoutMillis));
+  }
+  PROFILE_SCOPE(TRANSPORT_POLL); // From here on: dispatching, not waiting
+  // Only what is queued now: a handler that keeps causing events cannot
+  // hold the loop here
+  uint16_t head = eventHead.load(std::memory_order_acquire);
+  for (; tail != head; tail++)
+  {
+    dispatchEvent(eventQueue[tail & (BLE_EVENT_QUEUE_SIZE - 1)]);
+    eventTail.store(tail + 1, std::memory_order_release);
+  }
+}
+
+uint32_t transportDroppedEvents()
+{
+  return droppedEvents.load(std::memory_order_relaxed);
+}
+#else
+void transportPoll(unsigned long timeoutMillis)
+{
+  if (timeoutMillis)
+  {
+    HCITransport.wait(timeoutMillis); // Returns early as soon as the controller has an event
+  }
+  PROFILE_SCOPE(TRANSPORT_POLL); // From here on: processing, not waiting
+  BLE.poll();
+}
+#endif
+
+String transportAddress()
+{
+  String address;
+  withStack([&]() { address = BLE.address(); });
+  return address;
+}
+
+// --- Characteristic store ---
+
+bool transportWriteValue(GattCharacteristicId characteristic, const uint8_t *data, size_t length)
+{
+  bool written = false;
+  withStack([&]() { written = characteristics[characteristic].writeValue(data, length); });
+  return written;
+}
+
+// ArduinoBLE notifies from every writeValue() and has no call that only
+// stores. value() is the characteristic's own buffer, though, which reads
+// and later notifications send as is: once the value has its length, a new
+// one of the same length is copied straight into it. Only a first value or
+// a change of length goes through writeValue(); the values are populated in
+// setup(), before anyone can subscribe.
+bool transportSetValue(GattCharacteristicId characteristic, const uint8_t *data, size_t length)
+{
+  bool set = false;
+  withStack([&]() {
+    BLECharacteristic &target = characteristics[characteristic];
+    if (target.value() && target.valueLength() == (int)length)
+    {
+      memcpy(const_cast<uint8_t *>(target.value()), data, length);
+      set = true;
+    }
+    else
+    {
+      set = target.writeValue(data, length);
+    }
+  });
+  return set;
+}
+
+#if CTS_BLE_THREAD
+const uint8_t *transportValue(GattCharacteristicId characteristic, size_t &length)
+{
+  // The stack's copy may already hold a newer write: use the one captured
+  // with the event
+  bool current = dispatching && dispatching->characteristic == characteristic;
+  length = current ? dispatching->valueLength : 0;
+  return current ? dispatching->value : NULL;
+}
+#else
+const uint8_t *transportValue(GattCharacteristicId characteristic, size_t &length)
+{
+  length = characteristics[characteristic].valueLength();
+  return characteristics[characteristic].value();
+}
+#endif
+
+// --- Event dispatch ---
+
+void transportSetPeerHandler(TransportPeerEvent event, TransportPeerHandler handler)
+{
+  peerHandlers[event] = handler;
+  BLEDeviceEventHandler stackHandler = handler ? peerTrampolines[event] : NULL;
+  withStack([&]() { BLE.setEventHandler(peerEvents[event], stackHandler); });
+}
+
+void transportSetCharacteristicHandler(GattCharacteristicId characteristic, TransportCharacteristicEvent event,
+                                       TransportCharacteristicHandler handler)
+{
+  characteristicHandlers[characteristic][event] = handler;
+  withStack([&]() {
+    characteristics[characteristic].setEventHandler(characteristicEvents[event], handler ? trampolines[characteristic][event] : NULL);
+  });
+}
+
+// --- Advertising and scanning ---
+
+void transportSetAdvertisingInterval(uint16_t interval)
+{
+  withStack([&]() { BLE.setAdvertisingInterval(interval); });
+}
+
+void transportSetManufacturerData(const uint8_t *data, int length)
+{
+  withStack([&]() { BLE.setManufacturerData(data, length); });
+}
+
+bool transportAdvertise()
+{
+  bool started = false;
+  withStack([&]() { started = BLE.advertise(); });
+  return started;
+}
+
+void transportStopAdvertise()
+{
+  withStack([&]() { BLE.stopAdvertise(); });
+}
+
+bool transportScan(bool withDuplicates)
+{
+  bool started = false;
+  withStack([&]() { started = BLE.scan(withDuplicates); });
+  return started;
+}
+
+void transportStopScan()
+{
+  withStack([&]() { BLE.stopScan(); });
+}
+
+// --- Link control ---
+
+bool transportDisconnect(const BleAddress &peer)
+{
+  bool disconnected = false;
+  withStack([&]() {
+    uint16_t handle = connectionHandle(peer);
+    disconnected = handle != 0xFFFF && HCI.disconnect(handle) == 0;
+  });
+  return disconnected;
+}
+
+void transportSetPreferredConnection(uint16_t minInterval, uint16_t maxInterval, uint16_t supervisionTimeout)
+{
+  withStack([&]() {
+    BLE.setConnectionInterval(minInterval, maxInterval);
+    BLE.setSupervisionTimeout(supervisionTimeout);
+  });
+}
+
+bool transportUpdateConnection(const BleAddress &peer, uint16_t minInterval, uint16_t maxInterval,
+                               uint16_t latency, uint16_t supervisionTimeout)
+{
+  bool sent = false;
+  withStack([&]() {
+    uint16_t handle = connectionHandle(peer);
+    sent = handle != 0xFFFF &&
+           HCI.leConnUpdate(handle, minInterval, maxInterval, latency, supervisionTimeout) == 0;
+  });
+  return sent;
+}
+
+#endif
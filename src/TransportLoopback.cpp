@@ -0,0 +1,292 @@
+#include "Transport.h"
+
+#if CTS_TRANSPORT == TRANSPORT_LOOPBACK
+
+#include <string.h>
+#include "Profiler.h"
+
+// Everything lives in fixed arrays and each driver call runs the handler
+// directly, so the cost measured around a driver call is the server's own.
+
+struct LoopbackPeerSlot
+{
+  TransportPeer peer;
+  bool inUse;
+  uint32_t subscriptions; // Bit per GattCharacteristicId
+};
+
+static_assert(GATT_CHARACTERISTIC_COUNT <= 32, "Subscriptions are a 32-bit mask");
+
+static uint8_t values[GATT_CHARACTERISTIC_COUNT][gattMaxValueSize()];
+static size_t valueLengths[GATT_CHARACTERISTIC_COUNT];
+static uint8_t subscriberCounts[GATT_CHARACTERISTIC_COUNT];
+static uint32_t notificationCounts[GATT_CHARACTERISTIC_COUNT];
+static LoopbackPeerSlot peers[LOOPBACK_MAX_PEERS];
+static TransportPeerHandler peerHandlers[TRANSPORT_PEER_EVENT_COUNT];
+static TransportCharacteristicHandler characteristicHandlers[GATT_CHARACTERISTIC_COUNT][TRANSPORT_CHARACTERISTIC_EVENT_COUNT];
+static bool advertising = false;
+static bool scanning = false;
+
+static LoopbackPeerSlot *findPeer(const BleAddress &address)
+{
+  for (uint8_t i = 0; i < LOOPBACK_MAX_PEERS; i++)
+  {
+    if (peers[i].inUse && peers[i].peer.address() == address)
+    {
+      return &peers[i];
+    }
+  }
+  return NULL;
+}
+
+// --- Lifecycle ---
+
+bool transportBegin(const char *deviceName)
+{
+  (void)deviceName;
+  return true;
+}
+
+// Nothing is ever pending, so waiting is all there is to do
+void transportPoll(unsigned long timeoutMillis)
+{
+  if (timeoutMillis)
+  {
+    delay(timeoutMillis);
+  }
+  PROFILE_SCOPE(TRANSPORT_POLL);
+}
+
+String transportAddress()
+{
+  return String("c0:ff:ee:00:00:01");
+}
+
+// --- Characteristic store ---
+
+bool transportWriteValue(GattCharacteristicId characteristic, const uint8_t *data, size_t length)
+{
+  if (length > gattCharacteristics[characteristic].valueSize)
+  {
+    return false;
+  }
+  memcpy(values[characteristic], data, length);
+  valueLengths[characteristic] = length;
+  notificationCounts[characteristic] += subscriberCounts[characteristic]; // One PDU per subscribed peer
+  return true;
+}
+
+bool transportSetValue(GattCharacteristicId characteristic, const uint8_t *data, size_t length)
+{
+  if (length > gattCharacteristics[characteristic].valueSize)
+  {
+    return false;
+  }
+  memcpy(values[characteristic], data, length);
+  valueLengths[characteristic] = length;
+  return true;
+}
+
+const uint8_t *transportValue(GattCharacteristicId characteristic, size_t &length)
+{
+  length = valueLengths[characteristic];
+  return values[characteristic];
+}
+
+// --- Event dispatch ---
+
+void transportSetPeerHandler(TransportPeerEvent event, TransportPeerHandler handler)
+{
+  peerHandlers[event] = handler;
+}
+
+void transportSetCharacteristicHandler(GattCharacteristicId characteristic, TransportCharacteristicEvent event,
+                                       TransportCharacteristicHandler handler)
+{
+  characteristicHandlers[characteristic][event] = handler;
+}
+
+// --- Advertising and scanning ---
+
+void transportSetAdvertisingInterval(uint16_t interval)
+{
+  (void)interval;
+}
+
+void transportSetManufacturerData(const uint8_t *data, int length)
+{
+  (void)data;
+  (void)length;
+}
+
+bool transportAdvertise()
+{
+  advertising = true;
+  return true;
+}
+
+void transportStopAdvertise()
+{
+  advertising = false;
+}
+
+bool transportScan(bool withDuplicates)
+{
+  (void)withDuplicates; // Every loopbackAdvertisement() is reported
+  scanning = true;
+  return true;
+}
+
+void transportStopScan()
+{
+  scanning = false;
+}
+
+// --- Link control ---
+
+bool transportDisconnect(const BleAddress &peer)
+{
+  LoopbackPeerSlot *slot = findPeer(peer);
+  if (!slot)
+  {
+    return false;
+  }
+  loopbackDisconnect(slot->peer);
+  return true;
+}
+
+void transportSetPreferredConnection(uint16_t minInterval, uint16_t maxInterval, uint16_t supervisionTimeout)
+{
+  (void)minInterval;
+  (void)maxInterval;
+  (void)supervisionTimeout;
+}
+
+bool transportUpdateConnection(const BleAddress &peer, uint16_t minInterval, uint16_t maxInterval,
+                               uint16_t latency, uint16_t supervisionTimeout)
+{
+  (void)minInterval;
+  (void)maxInterval;
+  (void)latency;
+  (void)supervisionTimeout;
+  return findPeer(peer) != NULL;
+}
+
+// --- Loopback driver ---
+
+void loopbackConnect(const TransportPeer &peer)
+{
+  if (findPeer(peer.address()))
+  {
+    return;
+  }
+  for (uint8_t i = 0; i < LOOPBACK_MAX_PEERS; i++)
+  {
+    if (!peers[i].inUse)
+    {
+      peers[i].peer = peer;
+      peers[i].inUse = true;
+      peers[i].subscriptions = 0;
+      advertising = false; // Like the controller, stop advertising on a new link
+      if (peerHandlers[TRANSPORT_CONNECTED])
+      {
+        peerHandlers[TRANSPORT_CONNECTED](peer);
+      }
+      return;
+    }
+  }
+}
+
+void loopbackDisconnect(const TransportPeer &peer)
+{
+  LoopbackPeerSlot *slot = findPeer(peer.address());
+  if (!slot)
+  {
+    return;
+  }
+  for (uint8_t i = 0; i < GATT_CHARACTERISTIC_COUNT; i++)
+  {
+    if (slot->subscriptions & (1UL << i))
+    {
+      subscriberCounts[i]--;
+    }
+  }
+  slot->inUse = false;
+  if (peerHandlers[TRANSPORT_DISCONNECTED])
+  {
+    peerHandlers[TRANSPORT_DISCONNECTED](peer);
+  }
+}
+
+bool loopbackWrite(const TransportPeer &peer, GattCharacteristicId characteristic, const uint8_t *data, size_t length)
+{
+  if (!findPeer(peer.address()) || !(gattCharacteristics[characteristic].properties & GATT_WRITE) ||
+      length > gattCharacteristics[characteristic].valueSize)
+  {
+    return false;
+  }
+  memcpy(values[characteristic], data, length);
+  valueLengths[characteristic] = length;
+  if (characteristicHandlers[characteristic][TRANSPORT_WRITTEN])
+  {
+    characteristicHandlers[characteristic][TRANSPORT_WRITTEN](peer, characteristic);
+  }
+  return true;
+}
+
+int loopbackRead(const TransportPeer &peer, GattCharacteristicId characteristic, uint8_t *data, size_t size)
+{
+  if (!findPeer(peer.address()) || !(gattCharacteristics[characteristic].properties & GATT_READ))
+  {
+    return -1;
+  }
+  if (characteristicHandlers[characteristic][TRANSPORT_READ])
+  {
+    characteristicHandlers[characteristic][TRANSPORT_READ](peer, characteristic);
+  }
+  size_t length = valueLengths[characteristic] < size ? valueLengths[characteristic] : size;
+  memcpy(data, values[characteristic], length);
+  return length;
+}
+
+bool loopbackSubscribe(const TransportPeer &peer, GattCharacteristicId characteristic, bool enabled)
+{
+  LoopbackPeerSlot *slot = findPeer(peer.address());
+  if (!slot || !(gattCharacteristics[characteristic].properties & GATT_NOTIFY))
+  {
+    return false;
+  }
+  uint32_t bit = 1UL << characteristic;
+  if (((slot->subscriptions & bit) != 0) == enabled)
+  {
+    return true;
+  }
+  slot->subscriptions ^= bit;
+  subscriberCounts[characteristic] += enabled ? 1 : -1;
+  TransportCharacteristicEvent event = enabled ? TRANSPORT_SUBSCRIBED : TRANSPORT_UNSUBSCRIBED;
+  if (characteristicHandlers[characteristic][event])
+  {
+    characteristicHandlers[characteristic][event](peer, characteristic);
+  }
+  return true;
+}
+
+void loopbackAdvertisement(const TransportPeer &peer)
+{
+  if (scanning && peerHandlers[TRANSPORT_DISCOVERED])
+  {
+    peerHandlers[TRANSPORT_DISCOVERED](peer);
+  }
+}
+
+uint32_t loopbackNotificationCount(GattCharacteristicId characteristic)
+{
+  return notificationCounts[characteristic];
+}
+
+bool loopbackAdvertising()
+{
+  return advertising;
+}
+
+#endif
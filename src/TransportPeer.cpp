@@ -0,0 +1,27 @@
+#include "Transport.h"
+#include <string.h>
+
+TransportPeer::TransportPeer() : _address(), _manufacturerDataLength(0)
+{
+}
+
+TransportPeer::TransportPeer(const BleAddress &address, const uint8_t *manufacturerData, int manufacturerDataLength)
+    : _address(address)
+{
+  if (manufacturerDataLength < 0)
+  {
+    manufacturerDataLength = 0;
+  }
+  _manufacturerDataLength = manufacturerDataLength < (int)sizeof(_manufacturerData) ? manufacturerDataLength : sizeof(_manufacturerData);
+  if (_manufacturerDataLength)
+  {
+    memcpy(_manufacturerData, manufacturerData, _manufacturerDataLength);
+  }
+}
+
+int TransportPeer::manufacturerData(uint8_t value[], int length) const
+{
+  int copied = _manufacturerDataLength < length ? _manufacturerDataLength : length;
+  memcpy(value, _manufacturerData, copied);
+  return copied;
+}
@@ -1,41 +1,91 @@
-#include <ArduinoBLE.h>
 #include <TaskScheduler.h>
+#include "Timebase.h"
+#include "EpochClock.h"
+#include "DriftEstimator.h"
+#include "NotifyPolicy.h"
+#include "AdvertisingScheduler.h"
+#include "ConnectionParams.h"
+#include "ConnectionTable.h"
+#include "CtsCodec.h"
+#include "CurrentTimeParser.h"
+#include "GatewayTime.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "TicklessIdle.h"
+#include "TimeBeacon.h"
+#include "TimeState.h"
+#include "Transport.h"
 
 // --- Configuration ---
 #define DEVICE_NAME "S&B Watch"
 #define LED_PIN LED_BUILTIN // 使用內建 LED
 
-// --- CTS UUIDs ---
-const char *ctsServiceUUID = "00001805-0000-1000-8000-00805F9B34FB";
-const char *currentTimeCharUUID = "00002A2B-0000-1000-8000-00805F9B34FB";
-const char *localTimeInfoCharUUID = "00002A0F-0000-1000-8000-00805F9B34FB";
-const char *refTimeInfoCharUUID = "00002A14-0000-1000-8000-00805F9B34FB";
-
-// --- BLE Service and Characteristics ---
-BLEService ctsService(ctsServiceUUID);
-// Add BLEWrite permission to currentTimeChar
-BLECharacteristic currentTimeChar(currentTimeCharUUID, BLERead | BLENotify | BLEWrite, 10); // 10 bytes for Current Time
-BLECharacteristic localTimeInfoChar(localTimeInfoCharUUID, BLERead, 2);                     // 2 bytes for Local Time Information
-BLECharacteristic refTimeInfoChar(refTimeInfoCharUUID, BLERead, 4);                         // 4 bytes for Reference Time Information
-
-// --- Time Structure ---
-struct DateTime
-{
-  uint16_t year;
-  uint8_t month;
-  uint8_t day;
-  uint8_t hour;
-  uint8_t minute;
-  uint8_t second;
-  uint8_t dayOfWeek; // 1 = Monday, 7 = Sunday
-};
+// Tickless mode: sleep in transportPoll() until the next task deadline instead of
+// polling BLE every 5ms from tBlePoll (set to 0 to restore the busy poll task)
+#ifndef CTS_TICKLESS
+#define CTS_TICKLESS 1
+#endif
+#define TICKLESS_MAX_SLEEP_MS 1000 // Upper bound for a single idle wait
+#define REJECT_TRACE_INTERVAL_MS 1000 // At most one trace per second for malformed Current Time writes
+#define REJECT_TRACE_MAX_BYTES 16     // Payload bytes kept in that trace
+#define LOG_DRAIN_CHUNK_BYTES 64      // Per drain pass when Serial cannot tell how much it accepts
+
+// Gateway time: also take the time from signed broadcasts of a local gateway
+// (see GatewayTime.h), scanning for a short window now and then. Off by
+// default; the CTS server works the same either way.
+#ifndef CTS_GATEWAY_TIME
+#define CTS_GATEWAY_TIME 0
+#endif
+#if CTS_GATEWAY_TIME && defined(GATEWAY_TIME_DEVELOPMENT_KEY) && !defined(CTS_NATIVE_SIM) && \
+    !defined(GATEWAY_TIME_ALLOW_DEVELOPMENT_KEY)
+#error "CTS_GATEWAY_TIME on hardware needs -DGATEWAY_TIME_KEY=...; the development key is public (-DGATEWAY_TIME_ALLOW_DEVELOPMENT_KEY for a bench)"
+#endif
+#define GATEWAY_SCAN_INTERVAL_MS 3600000 // Between windows after a broadcast was applied
+#define GATEWAY_SCAN_RETRY_MS 60000      // Between windows while no gateway is heard
+#define GATEWAY_SCAN_WINDOW_MS 5000      // Scan at most this long per window
+
+// Diagnostics characteristic (CtsDiagnostics in CtsSchema.h): answered on
+// demand by a read hook, or with CTS_BLE_THREAD refreshed by tDiagnostics
+// because the counters belong to the application thread
+#define DIAGNOSTICS_VERSION 1
+#define DIAGNOSTICS_SYNCED 0x01         // flags: a reference time was applied since boot
+#define DIAGNOSTICS_PROFILER 0x02       // flags: the probe fields are filled in (CTS_PROFILER)
+#define DIAGNOSTICS_BLE_THREAD 0x04     // flags: built with CTS_BLE_THREAD
+#define DIAGNOSTICS_GATEWAY_TIME 0x08   // flags: built with CTS_GATEWAY_TIME
+#define DIAGNOSTICS_REFRESH_MS 10000    // tDiagnostics period (CTS_BLE_THREAD only)
+#define SCHEDULER_OVERRUN_MS 20         // A scheduler pass at least this long counts as an overrun
+
+// The CTS service and its characteristics are declared in GattTable.h
 
 // --- Global Variables ---
-DateTime currentDateTime = {2024, 1, 1, 0, 0, 0, 1}; // Initial time: 2024-01-01 00:00:00 Monday
-unsigned long lastTimeUpdateMillis = 0;
-bool centralConnected = false;
-BLEDevice connectedCentral;
+// The clock and its sync record belong to the writer (updateInternalTime()
+// and applyReferenceTime()); everything else reads them through timeState
+EpochClock systemClock(1704067200); // Initial time: 2024-01-01 00:00:00 Monday
+DriftEstimator driftEstimator;      // Learns the crystal error from successive syncs
+uint64_t lastSyncRawTicks = 0;      // systemClock.rawTicks() when the time was last set
+uint64_t lastSyncSpanTicks = 0;     // Raw ticks between the last two syncs (0 until there were two)
+bool timeSynced = false;            // A client has set the time since boot
+TimeState timeState;                // Published copy of the above, see publishTime() / readTime()
+TimeBeacon timeBeacon;              // Clock state published in the advertising manufacturer data
+NotifyPolicy notifyPolicy;          // When to push Current Time to a subscribed client
+ConnectionTable connections;        // Per-central state, up to MAX_CENTRALS at once
+ConnectionParams connectionParams(connections); // SYNC profile while a link is busy, IDLE once quiet
+AdvertisingScheduler advertising;   // Fast advertising after boot/disconnect, backing off over time
+bool advertiseBurst = true;         // Whether the next restart begins with the fast phase
 bool ledState = false;
+uint32_t acceptedWriteCount = 0;       // Current Time writes applied since boot
+uint32_t rejectedWriteCount = 0;       // Malformed Current Time writes since boot
+uint16_t suppressedRejectCount = 0;    // Rejections not traced since the last one that was
+unsigned long lastRejectTraceMillis = 0;
+bool rejectTraced = false;
+const uint8_t gatewayTimeKey[SIP_HASH_KEY_SIZE] = GATEWAY_TIME_KEY;
+GatewayTimeReceiver gatewayTime(gatewayTimeKey); // Verifies gateway broadcasts and drops repeats
+bool gatewayScanning = false;                    // A scan window is open
+uint32_t connectCount = 0;                       // Connection events since boot, including refused ones
+uint32_t disconnectCount = 0;
+uint32_t schedulerOverrunCount = 0;              // Scheduler passes of SCHEDULER_OVERRUN_MS or more
+uint32_t notificationCount = 0;                  // Current Time notifications handed to the stack
 
 // --- Task Scheduler ---
 Scheduler ts;
@@ -46,129 +96,214 @@ void updateInternalTimeCallback();
 void updateBleDataCallback();
 void blePollCallback();         // Task for BLE polling
 void printSystemTimeCallback(); // New task declaration
+void sendInitialCharacteristicsCallback();
+void restartAdvertisingCallback();
+void scheduleAdvertisingStep(unsigned long delayMillis);
+void timeBeaconCallback();
+void logDrainCallback();
+void connectionIdleCallback();
+void advertisingStepCallback();
+void gatewayScanCallback();
+void profileReportCallback();
+void diagnosticsCallback();
 
 // --- Task Definitions ---
 Task tLedBlink(1000, TASK_FOREVER, &blinkLedCallback, &ts, true);             // Blink LED every 1000ms (slower)
-Task tUpdateTime(1000, TASK_FOREVER, &updateInternalTimeCallback, &ts, true); // Update internal time every second
-Task tUpdateBleData(1500, TASK_FOREVER, &updateBleDataCallback, &ts, true);   // Update BLE characteristics every 1.5 seconds if connected (slower)
-Task tBlePoll(5, TASK_FOREVER, &blePollCallback, &ts, true);                  // Poll BLE events more frequently (every 5ms)
+Task tUpdateTime(TIMEBASE_UPDATE_INTERVAL_MS, TASK_FOREVER, &updateInternalTimeCallback, &ts, true); // Update internal time (every second on millis(), hourly on the RTC)
+Task tUpdateBleData(TASK_IMMEDIATE, TASK_FOREVER, &updateBleDataCallback, &ts, false); // Notify subscribers; runs only while subscribed, sleeping until the next minute
+Task tBlePoll(5, TASK_FOREVER, &blePollCallback, &ts, !CTS_TICKLESS);        // Poll BLE events more frequently (every 5ms), unused in tickless mode
 Task tPrintTime(5000, TASK_FOREVER, &printSystemTimeCallback, &ts, true);     // New task: Print system time every 5 seconds
 
+// One-shot connection tasks, armed from the BLE event handlers so the
+// handlers return to transportPoll() immediately instead of blocking in delay()
+Task tSendInitialCharacteristics(10, 3, &sendInitialCharacteristicsCallback, &ts, false); // After connect: 3 writes, 10ms apart
+Task tRestartAdvertising(TASK_IMMEDIATE, TASK_ONCE, &restartAdvertisingCallback, &ts, false); // After disconnect
+Task tLogDrain(10, TASK_FOREVER, &logDrainCallback, &ts, false); // Drain the log buffer to Serial; enabled only while it holds data
+Task tConnectionIdle(TASK_IMMEDIATE, TASK_ONCE, &connectionIdleCallback, &ts, false); // Move quiet links to the IDLE connection profile
+Task tAdvertisingStep(TASK_IMMEDIATE, TASK_ONCE, &advertisingStepCallback, &ts, false); // Back off to the next advertising phase
+Task tTimeBeacon(TIME_BEACON_REFRESH_MS, TASK_FOREVER, &timeBeaconCallback, &ts, true); // Keep the advertised time stamp fresh
+Task tGatewayScan(TASK_IMMEDIATE, TASK_ONCE, &gatewayScanCallback, &ts, CTS_GATEWAY_TIME); // Open or close a gateway scan window
+Task tProfileReport(PROFILE_REPORT_INTERVAL_MS, TASK_FOREVER, &profileReportCallback, &ts, CTS_PROFILER); // Trace the hot-path timings
+Task tDiagnostics(DIAGNOSTICS_REFRESH_MS, TASK_FOREVER, &diagnosticsCallback, &ts, CTS_BLE_THREAD); // Refresh the diagnostics value when no read hook can
+
+#if CTS_TICKLESS
+// Tasks whose deadlines bound the idle sleep
+Task *const idleWatchedTasks[] = {&tLedBlink, &tUpdateTime, &tUpdateBleData, &tPrintTime,
+                                  &tSendInitialCharacteristics, &tRestartAdvertising, &tLogDrain, &tConnectionIdle,
+                                  &tAdvertisingStep, &tTimeBeacon, &tGatewayScan, &tProfileReport, &tDiagnostics};
+TicklessIdle idle(ts, idleWatchedTasks, sizeof(idleWatchedTasks) / sizeof(idleWatchedTasks[0]), TICKLESS_MAX_SLEEP_MS);
+#endif
+
 // --- Function Implementations ---
 
-// Calculate days in a given month and year
-uint8_t daysInMonth(uint16_t year, uint8_t month)
+// Publish the clock and sync record as one snapshot (writer side only)
+void publishTime()
 {
-  if (month == 4 || month == 6 || month == 9 || month == 11)
-  {
-    return 30;
-  }
-  else if (month == 2)
-  {
-    // Leap year check
-    bool isLeap = ((year % 4 == 0 && year % 100 != 0) || (year % 400 == 0));
-    return isLeap ? 29 : 28;
-  }
-  else
-  {
-    return 31;
-  }
+  TimeSnapshot snapshot;
+  snapshot.clock = systemClock;
+  snapshot.lastSyncRawTicks = lastSyncRawTicks;
+  snapshot.lastSyncSpanTicks = lastSyncSpanTicks;
+  snapshot.lastOffsetTicks = driftEstimator.lastOffsetTicks();
+  snapshot.synced = timeSynced;
+  timeState.write(snapshot);
 }
 
-// Update internal time structure
+// Update internal time (advances the epoch counter, no calendar math)
 void updateInternalTime()
 {
-  unsigned long currentMillis = millis();
-  if (currentMillis - lastTimeUpdateMillis >= 1000)
-  {
-    unsigned long elapsedSeconds = (currentMillis - lastTimeUpdateMillis) / 1000;
-    lastTimeUpdateMillis += elapsedSeconds * 1000;
-
-    currentDateTime.second += elapsedSeconds;
-
-    // Handle rollovers
-    if (currentDateTime.second >= 60)
-    {
-      currentDateTime.minute += currentDateTime.second / 60;
-      currentDateTime.second %= 60;
-      if (currentDateTime.minute >= 60)
-      {
-        currentDateTime.hour += currentDateTime.minute / 60;
-        currentDateTime.minute %= 60;
-        if (currentDateTime.hour >= 24)
-        {
-          uint8_t daysElapsed = currentDateTime.hour / 24;
-          currentDateTime.day += daysElapsed;
-          currentDateTime.hour %= 24;
-          currentDateTime.dayOfWeek = ((currentDateTime.dayOfWeek - 1 + daysElapsed) % 7) + 1;
-
-          uint8_t monthDays = daysInMonth(currentDateTime.year, currentDateTime.month);
-          while (currentDateTime.day > monthDays)
-          {
-            currentDateTime.day -= monthDays;
-            currentDateTime.month++;
-            if (currentDateTime.month > 12)
-            {
-              currentDateTime.month = 1;
-              currentDateTime.year++;
-            }
-            monthDays = daysInMonth(currentDateTime.year, currentDateTime.month);
-          }
-        }
-      }
-    }
-    // Serial.print("."); // Indicate time update
-  }
+  PROFILE_SCOPE(UPDATE_INTERNAL_TIME);
+  systemClock.update(timebaseNow());
+  publishTime();
 }
 
-// Format and write Current Time characteristic data
-void writeCurrentTime()
+// The time as of now, for serializing: the latest snapshot with its private
+// clock copy advanced to the current timebase tick. Never blocks the writer
+// and never changes shared state, so any context may call it.
+TimeSnapshot readTime()
 {
-  uint8_t timeData[10];
-  timeData[0] = currentDateTime.year & 0xFF;
-  timeData[1] = (currentDateTime.year >> 8) & 0xFF;
-  timeData[2] = currentDateTime.month;
-  timeData[3] = currentDateTime.day;
-  timeData[4] = currentDateTime.hour;
-  timeData[5] = currentDateTime.minute;
-  timeData[6] = currentDateTime.second;
-  timeData[7] = currentDateTime.dayOfWeek;
-  timeData[8] = 0; // Fractions256 - We don't support setting this via write
-  timeData[9] = 1; // Adjust Reason: Manual time update
+  TimeSnapshot now = timeState.read();
+  now.clock.update(timebaseNow());
+  return now;
+}
 
-  // Check if writeValue was successful (optional, but good for debugging)
-  if (!currentTimeChar.writeValue(timeData, sizeof(timeData)))
+// Current Time characteristic value for the time as of now. Uses only
+// readTime(), so any context may call it.
+void encodeCurrentTime(uint8_t adjustReason, uint8_t *data)
+{
+  TimeSnapshot time = readTime(); // Fractions256 must reflect the moment of the write
+  const DateTime &now = time.clock.dateTime();
+  CtsCurrentTime currentTime = {now.year, now.month, now.day,
+                                now.hour, now.minute, now.second, now.dayOfWeek,
+                                time.clock.fractions256(), // Fractions256: sub-second phase
+                                adjustReason};              // Adjust Reason bits, 0 when the time was not adjusted
+  currentTime.encode(data);
+}
+
+// Bring the stored Current Time up to date without notifying anyone, for the
+// read hook and for populating the value. Uses only readTime() and the
+// transport, so the read hook may call it from the BLE thread.
+bool refreshCurrentTime()
+{
+  uint8_t timeData[CtsCurrentTime::WIRE_SIZE];
+  encodeCurrentTime(CTS_ADJUST_NONE, timeData);
+  return transportSetValue(GATT_CURRENT_TIME, timeData, sizeof(timeData));
+}
+
+// Notify subscribed clients of the time as of now. Only for notifications
+// NotifyPolicy approved (application context).
+void writeCurrentTime(uint8_t adjustReason)
+{
+  PROFILE_SCOPE(WRITE_CURRENT_TIME);
+  uint8_t timeData[CtsCurrentTime::WIRE_SIZE];
+  encodeCurrentTime(adjustReason, timeData);
+  if (!transportWriteValue(GATT_CURRENT_TIME, timeData, sizeof(timeData)))
   {
-    Serial.println("Error writing Current Time characteristic!");
+    TRACE(CURRENT_TIME_WRITE_FAILED);
+    return;
   }
-  // Serial.println("Current Time Characteristic Updated");
+  notificationCount += connections.subscriberCount(); // The stack notifies every subscriber
 }
 
 // Write Local Time Information characteristic data (Example: UTC+8, no DST)
 void writeLocalTimeInfo()
 {
-  uint8_t localTimeData[2];
-  int8_t timeZone = 32;  // UTC+8 (8 * 4 quarters)
-  uint8_t dstOffset = 0; // Standard Time
-
-  localTimeData[0] = timeZone;
-  localTimeData[1] = dstOffset;
-  localTimeInfoChar.writeValue(localTimeData, sizeof(localTimeData));
+  CtsLocalTimeInfo localTime = {32, // Time zone: UTC+8 (8 * 4 quarters)
+                                0}; // DST offset: Standard Time
+  uint8_t localTimeData[CtsLocalTimeInfo::WIRE_SIZE];
+  localTime.encode(localTimeData);
+  transportSetValue(GATT_LOCAL_TIME_INFO, localTimeData, sizeof(localTimeData));
   // Serial.println("Local Time Info Characteristic Updated");
 }
 
 // Write Reference Time Information characteristic data (Example: Manual source)
 void writeRefTimeInfo()
 {
-  uint8_t refTimeData[4];
-  refTimeData[0] = 4;   // Source: Manual
-  refTimeData[1] = 254; // Accuracy: Inaccurate (within 5s) or use a specific value if known
-  refTimeData[2] = 0;   // Days since update (unknown)
-  refTimeData[3] = 0;   // Fractions256 since update (unknown)
-  refTimeInfoChar.writeValue(refTimeData, sizeof(refTimeData));
+  TimeSnapshot time = readTime();
+  uint32_t secondsSinceUpdate = time.ticksSinceSync() / CLOCK_TICKS_PER_SECOND;
+  uint32_t daysSinceUpdate = secondsSinceUpdate / 86400;
+  // Never set, or 255 days or more ago: both fields are 255, as CTS requires
+  bool stale = !time.synced || daysSinceUpdate >= 255;
+
+  CtsReferenceTimeInfo refTime = {4,   // Source: Manual
+                                  254, // Accuracy: Inaccurate (within 5s) or use a specific value if known
+                                  (uint8_t)(stale ? 255 : daysSinceUpdate),                     // Days since update
+                                  (uint8_t)(stale ? 255 : (secondsSinceUpdate / 3600) % 24)}; // Hours since update
+  uint8_t refTimeData[CtsReferenceTimeInfo::WIRE_SIZE];
+  refTime.encode(refTimeData);
+  transportSetValue(GATT_REFERENCE_TIME_INFO, refTimeData, sizeof(refTimeData));
   // Serial.println("Reference Time Info Characteristic Updated");
 }
 
+static void fillPhaseDiagnostics(AdvertisingPhaseId phase, uint32_t &connections, uint32_t &seconds)
+{
+  connections = advertising.stats().connections[phase];
+  seconds = advertising.millisInPhase(phase, millis()) / 1000;
+}
+
+#if CTS_PROFILER
+static void fillProbeDiagnostics(ProfileProbeId probe, uint32_t &calls, uint16_t &maxMicros, uint64_t &histogram)
+{
+  calls = profileStats(probe).count;
+  maxMicros = profileMaxMicros(probe);
+  histogram = profilePackedHistogram(probe);
+}
+#endif
+
+// Store the diagnostics characteristic: counters since boot and, when
+// profiling, the probe summaries. Application context only.
+void writeDiagnostics()
+{
+  CtsDiagnostics diagnostics = {};
+  TimeSnapshot time = readTime();
+  diagnostics.version = DIAGNOSTICS_VERSION;
+  diagnostics.flags = (time.synced ? DIAGNOSTICS_SYNCED : 0) | (CTS_PROFILER ? DIAGNOSTICS_PROFILER : 0) |
+                      (CTS_BLE_THREAD ? DIAGNOSTICS_BLE_THREAD : 0) | (CTS_GATEWAY_TIME ? DIAGNOSTICS_GATEWAY_TIME : 0);
+  diagnostics.uptimeSeconds = time.clock.rawTicks() / CLOCK_TICKS_PER_SECOND;
+  diagnostics.timeWritesAccepted = acceptedWriteCount;
+  diagnostics.timeWritesRejected = rejectedWriteCount;
+  diagnostics.notificationsSent = notificationCount;
+  diagnostics.connects = connectCount;
+  diagnostics.disconnects = disconnectCount;
+  diagnostics.advertisingStarts = advertising.stats().starts;
+  diagnostics.advertisingFailures = advertising.stats().failures;
+  diagnostics.schedulerOverruns = schedulerOverrunCount;
+  diagnostics.logDropped = logDroppedCount();
+#if CTS_BLE_THREAD
+  diagnostics.bleEventsDropped = transportDroppedEvents();
+#endif
+  diagnostics.gatewayTimesAccepted = gatewayTime.acceptedCount();
+  static_assert(ADV_PHASE_COUNT == 3, "CtsDiagnostics has a field group per advertising phase");
+  fillPhaseDiagnostics(ADV_PHASE_FAST, diagnostics.fastPhaseConnections, diagnostics.fastPhaseSeconds);
+  fillPhaseDiagnostics(ADV_PHASE_MEDIUM, diagnostics.mediumPhaseConnections, diagnostics.mediumPhaseSeconds);
+  fillPhaseDiagnostics(ADV_PHASE_SLOW, diagnostics.slowPhaseConnections, diagnostics.slowPhaseSeconds);
+#if CTS_PROFILER
+  static_assert(PROFILE_PROBE_COUNT == 4, "CtsDiagnostics has a field group per probe");
+  fillProbeDiagnostics(PROFILE_UPDATE_INTERNAL_TIME, diagnostics.updateTimeCalls, diagnostics.updateTimeMaxMicros,
+                       diagnostics.updateTimeHistogram);
+  fillProbeDiagnostics(PROFILE_WRITE_CURRENT_TIME, diagnostics.writeTimeCalls, diagnostics.writeTimeMaxMicros,
+                       diagnostics.writeTimeHistogram);
+  fillProbeDiagnostics(PROFILE_CURRENT_TIME_WRITTEN, diagnostics.timeWrittenCalls, diagnostics.timeWrittenMaxMicros,
+                       diagnostics.timeWrittenHistogram);
+  fillProbeDiagnostics(PROFILE_TRANSPORT_POLL, diagnostics.transportPollCalls, diagnostics.transportPollMaxMicros,
+                       diagnostics.transportPollHistogram);
+#endif
+  uint8_t diagnosticsData[CtsDiagnostics::WIRE_SIZE];
+  diagnostics.encode(diagnosticsData);
+  transportSetValue(GATT_DIAGNOSTICS, diagnosticsData, sizeof(diagnosticsData));
+}
+
+static_assert(2 + CtsTimeBeacon::WIRE_SIZE <= transportAdvertisedManufacturerDataSize(),
+              "The time beacon does not fit the advertising packet next to the service UUID");
+
+// Rebuild the advertised time beacon; goes on air with the next advertise()
+void updateTimeBeacon()
+{
+  TimeSnapshot time = readTime();
+  timeBeacon.update(time.clock.epochSeconds(), time.synced, time.ticksSinceSync(),
+                    time.lastSyncSpanTicks, time.lastOffsetTicks, time.clock.driftCorrectionPpb());
+  transportSetManufacturerData(timeBeacon.data(), timeBeacon.length());
+}
+
 // --- Task Callbacks ---
 
 void blinkLedCallback()
@@ -181,217 +316,461 @@ void updateInternalTimeCallback()
 {
   updateInternalTime();
   // Optional: Print time to Serial for debugging
+  // const DateTime &now = systemClock.dateTime();
   // Serial.printf("%04d-%02d-%02d %02d:%02d:%02d DOW:%d\n",
-  //               currentDateTime.year, currentDateTime.month, currentDateTime.day,
-  //               currentDateTime.hour, currentDateTime.minute, currentDateTime.second,
-  //               currentDateTime.dayOfWeek);
+  //               now.year, now.month, now.day,
+  //               now.hour, now.minute, now.second,
+  //               now.dayOfWeek);
+}
+
+// Milliseconds until the wall clock crosses the next minute boundary
+unsigned long millisUntilNextMinute()
+{
+  const uint64_t ticksPerMinute = 60 * CLOCK_TICKS_PER_SECOND;
+  uint64_t remaining = ticksPerMinute - readTime().clock.ticks() % ticksPerMinute;
+  return remaining * 1000 / CLOCK_TICKS_PER_SECOND + 1;
 }
 
 void updateBleDataCallback()
 {
-  if (centralConnected)
+  // Push Current Time only when the notification policy has a trigger;
+  // reads are answered on demand by the TRANSPORT_READ handlers
+  uint8_t adjustReason;
+  if (notifyPolicy.poll(readTime().clock.epochSeconds(), adjustReason))
   {
-    // Update internal time first to ensure latest value is sent
-    updateInternalTime();
-    // Write the current time characteristic
-    writeCurrentTime();
+    writeCurrentTime(adjustReason);
   }
+  // Nothing to do before the next minute unless an adjustment restarts us
+  tUpdateBleData.delay(millisUntilNextMinute());
 }
 
 void blePollCallback()
 {
-  BLE.poll(); // Process BLE events
+  transportPoll(0); // Process BLE events
 }
 
 // New Task Callback: Print current system time every 5 seconds
 void printSystemTimeCallback()
 {
-  // Ensure internal time is updated before printing
-  updateInternalTime();
+  TimeSnapshot time = readTime();
+  const DateTime &now = time.clock.dateTime();
 
-  // Format the time string
-  char timeBuffer[50];
-  snprintf(timeBuffer, sizeof(timeBuffer), "System Time: %04d-%02d-%02d %02d:%02d:%02d DOW:%d",
-           currentDateTime.year, currentDateTime.month, currentDateTime.day,
-           currentDateTime.hour, currentDateTime.minute, currentDateTime.second,
-           currentDateTime.dayOfWeek);
-  // Print the formatted time
-  Serial.println(timeBuffer);
+  // Queue the raw DateTime; the host decoder does the formatting
+  TRACE(SYSTEM_TIME, now);
 }
 
-// --- BLE Event Handlers ---
+// Write as much queued log output as the UART accepts without blocking.
+// Print::availableForWrite() returns 0 unless the port overrides it, so a 0
+// only means "full" from a port that has reported free space before; until
+// then each pass writes a fixed chunk.
+void logDrainCallback()
+{
+  static bool spaceReported = false;
+  int space = Serial.availableForWrite();
+  spaceReported |= space > 0;
+  if (!logDrain(spaceReported ? space : LOG_DRAIN_CHUNK_BYTES))
+  {
+    tLogDrain.disable(); // Re-enabled by wakeLogDrain() on the next message
+  }
+}
 
-// Handler for when the Current Time characteristic is written by a client
-void currentTimeWrittenHandler(BLEDevice central, BLECharacteristic characteristic)
+void wakeLogDrain()
 {
-  Serial.print("Current Time characteristic written by: ");
-  Serial.println(central.address());
+  tLogDrain.enableIfNot();
+}
 
-  if (characteristic.valueLength() == 10)
+// Connection state machine step: Current Time, then Local Time Information,
+// then Reference Time Information (one per iteration)
+void sendInitialCharacteristicsCallback()
+{
+  if (connections.count() == 0)
+  {
+    tSendInitialCharacteristics.disable();
+    return;
+  }
+  switch (tSendInitialCharacteristics.getRunCounter())
   {
-    const uint8_t *data = characteristic.value();
+  case 1:
+    refreshCurrentTime(); // Subscribers already have it; notifying them again is the policy's call
+    break;
+  case 2:
+    writeLocalTimeInfo();
+    break;
+  default:
+    writeRefTimeInfo();
+    TRACE(INITIAL_CHARACTERISTICS_SENT);
+    break;
+  }
+}
 
-    // Print the raw received data
-    Serial.print("  Raw Data Received: [");
-    for (int i = 0; i < 10; i++)
-    {
-      Serial.print("0x");
-      if (data[i] < 0x10)
-        Serial.print("0"); // Add leading zero for single digit hex
-      Serial.print(data[i], HEX);
-      if (i < 9)
-        Serial.print(", ");
-    }
-    Serial.println("]");
-
-    // Parse the received data according to CTS Current Time format
-    uint16_t year = data[0] | (data[1] << 8);
-    uint8_t month = data[2];
-    uint8_t day = data[3];
-    uint8_t hour = data[4];
-    uint8_t minute = data[5];
-    uint8_t second = data[6];
-    uint8_t dayOfWeek = data[7];
-    // uint8_t fractions256 = data[8]; // We ignore fractions and adjust reason on write
-    // uint8_t adjustReason = data[9];
-
-    // Basic validation (optional but recommended)
-    if (month >= 1 && month <= 12 && day >= 1 && day <= 31 &&
-        hour <= 23 && minute <= 59 && second <= 59 &&
-        dayOfWeek >= 1 && dayOfWeek <= 7)
-    {
-      // Update the internal time structure
-      currentDateTime.year = year;
-      currentDateTime.month = month;
-      currentDateTime.day = day;
-      currentDateTime.hour = hour;
-      currentDateTime.minute = minute;
-      currentDateTime.second = second;
-      currentDateTime.dayOfWeek = dayOfWeek;
-
-      // Reset the internal time update mechanism to sync with the new time
-      lastTimeUpdateMillis = millis();
-
-      Serial.println("Internal time updated by client:");
-      // Use snprintf to format the string into a buffer, then print the buffer
-      char timeBuffer[50]; // Create a buffer to hold the formatted string
-      snprintf(timeBuffer, sizeof(timeBuffer), "  New Time: %04d-%02d-%02d %02d:%02d:%02d DOW:%d",
-               currentDateTime.year, currentDateTime.month, currentDateTime.day,
-               currentDateTime.hour, currentDateTime.minute, currentDateTime.second,
-               currentDateTime.dayOfWeek);
-      Serial.println(timeBuffer); // Print the buffer content
-
-      // Optional: Immediately write the value back to confirm/notify (if needed)
-      // writeCurrentTime(); // Already handled by the periodic update task
-    }
-    else
-    {
-      Serial.println("Received invalid time data format.");
-    }
+// Re-armed until every link has settled in the IDLE profile
+void connectionIdleCallback()
+{
+  unsigned long nextIdle = connectionParams.update(millis());
+  if (nextIdle)
+  {
+    tConnectionIdle.restartDelayed(nextIdle);
+  }
+}
+
+void restartAdvertisingCallback()
+{
+  if (connections.full())
+  {
+    return; // No slot left for another central
+  }
+  // Restart advertising
+  updateTimeBeacon();
+  unsigned long nextStep = advertising.start(advertiseBurst, millis());
+  if (advertising.active())
+  {
+    TRACE(ADVERTISING_RESTARTED);
+    scheduleAdvertisingStep(nextStep);
   }
   else
   {
-    Serial.print("Received data with incorrect length: ");
-    Serial.println(characteristic.valueLength());
-    // Optionally print the incorrect data as well
-    const uint8_t *data = characteristic.value();
-    int len = characteristic.valueLength();
-    Serial.print("  Raw Data Received: [");
-    for (int i = 0; i < len; i++)
-    {
-      Serial.print("0x");
-      if (data[i] < 0x10)
-        Serial.print("0");
-      Serial.print(data[i], HEX);
-      if (i < len - 1)
-        Serial.print(", ");
-    }
-    Serial.println("]");
+    TRACE(ADVERTISING_RESTART_FAILED);
+    // Consider a more robust recovery like resetting BLE stack or device
   }
 }
 
-void blePeripheralConnectHandler(BLEDevice central)
+void scheduleAdvertisingStep(unsigned long delayMillis)
 {
-  Serial.print("Connected event for: ");
-  Serial.println(central.address());
-  digitalWrite(LED_PIN, HIGH); // Turn LED on when connected
-  ledState = HIGH;
-  tLedBlink.disable(); // Stop blinking when connected
+  if (delayMillis)
+  {
+    tAdvertisingStep.restartDelayed(delayMillis);
+  }
+  else
+  {
+    tAdvertisingStep.disable(); // Last phase, or advertising failed to start
+  }
+}
 
-  // Check if already connected to avoid race conditions
-  if (!centralConnected)
+void advertisingStepCallback()
+{
+  updateTimeBeacon();
+  scheduleAdvertisingStep(advertising.step(millis()));
+}
+
+void timeBeaconCallback()
+{
+  if (advertising.active())
   {
-    centralConnected = true;
-    connectedCentral = central; // Store the connected device
-    Serial.println("Connection established.");
+    updateTimeBeacon();
+    advertising.refresh();
+  }
+}
 
-    // Update characteristics immediately on connection
-    // Delay slightly before writing to allow connection stabilization
-    delay(50); // Small delay
-    writeCurrentTime();
-    delay(10);
-    writeLocalTimeInfo();
-    delay(10);
-    writeRefTimeInfo();
-    Serial.println("Initial characteristics sent.");
+// Alternates between a scan window and the wait before the next one; a
+// window that hears a gateway is closed early by gatewayDiscoveredHandler()
+void gatewayScanCallback()
+{
+  if (!gatewayScanning)
+  {
+    gatewayScanning = transportScan(true); // Duplicates too: each copy may carry a newer stamp
+    tGatewayScan.restartDelayed(gatewayScanning ? GATEWAY_SCAN_WINDOW_MS : GATEWAY_SCAN_RETRY_MS);
+    return;
   }
-  else
+  transportStopScan();
+  gatewayScanning = false;
+  tGatewayScan.restartDelayed(GATEWAY_SCAN_RETRY_MS);
+}
+
+void profileReportCallback()
+{
+#if CTS_PROFILER
+  profileReport();
+#endif
+}
+
+void diagnosticsCallback()
+{
+  writeDiagnostics();
+}
+
+// Run the due tasks, counting passes that hold up everything else (BLE
+// events included) for SCHEDULER_OVERRUN_MS or more
+void runScheduler()
+{
+  unsigned long start = millis();
+  ts.execute();
+  if (millis() - start >= SCHEDULER_OVERRUN_MS)
   {
-    Serial.println("Already connected, ignoring duplicate connect event.");
+    schedulerOverrunCount++;
   }
 }
 
-void blePeripheralDisconnectHandler(BLEDevice central)
+// --- BLE Event Handlers ---
+
+// Read hooks: the stack calls these right before answering a read request,
+// so values are computed on demand instead of being kept fresh by a task.
+// They only store (transportSetValue()): a read never notifies anyone.
+// With CTS_BLE_THREAD they run on the BLE thread, where the connection table
+// and the log are off limits: there only writes keep a link in SYNC.
+void currentTimeReadHandler(const TransportPeer &central, GattCharacteristicId characteristic)
+{
+#if !CTS_BLE_THREAD
+  connectionParams.onActivity(central.address(), millis()); // A read-back keeps the link in SYNC a little longer
+#endif
+  refreshCurrentTime(); // Answer this read only; notifications are the policy's call
+}
+
+void refTimeInfoReadHandler(const TransportPeer &central, GattCharacteristicId characteristic)
+{
+#if !CTS_BLE_THREAD
+  connectionParams.onActivity(central.address(), millis());
+#endif
+  writeRefTimeInfo();
+}
+
+#if !CTS_BLE_THREAD
+void diagnosticsReadHandler(const TransportPeer &central, GattCharacteristicId characteristic)
 {
-  Serial.print("Disconnected event for: ");
-  Serial.println(central.address());
-  digitalWrite(LED_PIN, LOW); // Turn LED off when disconnected
-  ledState = LOW;
+  writeDiagnostics();
+}
+#endif
 
-  // Only restart blinking and advertising if we were actually connected
-  if (centralConnected)
+void currentTimeSubscribedHandler(const TransportPeer &central, GattCharacteristicId characteristic)
+{
+  if (!connections.setSubscribed(central.address(), true))
   {
-    centralConnected = false;
-    tLedBlink.enable(); // Start blinking again
-    Serial.println("Connection terminated.");
+    return;
+  }
+  // Also re-sends the current value to earlier subscribers, which is
+  // harmless: one writeValue() reaches them all
+  notifyPolicy.setSubscribed(true, readTime().clock.epochSeconds());
+  tUpdateBleData.restart(); // Sends the initial value, then sleeps minute to minute
+}
 
-    // Explicitly stop advertising before restarting
-    BLE.stopAdvertise();
-    Serial.println("Stopped advertising.");
-    delay(100); // Short delay before restarting
+// Notifications stop only when the last subscriber is gone
+void updateSubscription()
+{
+  if (connections.subscriberCount() == 0)
+  {
+    notifyPolicy.setSubscribed(false, readTime().clock.epochSeconds());
+    tUpdateBleData.disable();
+  }
+}
 
-    // Restart advertising
-    if (BLE.advertise())
-    {
-      Serial.println("Restarted advertising.");
-    }
-    else
-    {
-      Serial.println("Failed to restart advertising!");
-      // Consider a more robust recovery like resetting BLE stack or device
-    }
+void currentTimeUnsubscribedHandler(const TransportPeer &central, GattCharacteristicId characteristic)
+{
+  if (connections.setSubscribed(central.address(), false))
+  {
+    updateSubscription();
+  }
+}
+
+// Set the clock from a validated reference time (a Current Time write or a
+// gateway broadcast) and let everything that depends on it know
+void applyReferenceTime(const ParsedCurrentTime &parsed, uint8_t adjustReason)
+{
+  // Record how far the local clock had drifted, then replace the epoch
+  // counter including the reference's sub-second phase
+  uint32_t nowTicks = timebaseNow();
+  systemClock.update(nowTicks);
+  uint64_t referenceTicks = parsed.epochSeconds * CLOCK_TICKS_PER_SECOND +
+                            EpochClock::ticksFromFractions256(parsed.fractions256);
+  int64_t offsetTicks = (int64_t)(referenceTicks - systemClock.ticks());
+  driftEstimator.addSync(systemClock.rawTicks(), referenceTicks, offsetTicks);
+  systemClock.setTicks(referenceTicks, nowTicks);
+  systemClock.setDriftCorrectionPpb(driftEstimator.correctionPpb());
+  lastSyncSpanTicks = timeSynced ? systemClock.rawTicks() - lastSyncRawTicks : 0;
+  lastSyncRawTicks = systemClock.rawTicks();
+  timeSynced = true;
+  publishTime(); // Readers see the new time and its sync record together
+  if (notifyPolicy.onTimeAdjusted(adjustReason, offsetTicks * 1000 / (int64_t)CLOCK_TICKS_PER_SECOND))
+  {
+    tUpdateBleData.restart(); // Notify subscribers now rather than at the next minute
+  }
+  const DateTime &now = systemClock.dateTime();
+
+  TRACE(TIME_UPDATED);
+  TRACE(NEW_TIME, now, parsed.fractions256);
+  TRACE(SYNC_OFFSET, (int64_t)(offsetTicks * 1000 / (int64_t)CLOCK_TICKS_PER_SECOND), (int32_t)driftEstimator.correctionPpb());
+
+  // Scanning hosts see the new state without waiting for the next refresh
+  updateTimeBeacon();
+  advertising.refresh();
+}
+
+// Count a malformed Current Time write. A misbehaving central can write in a
+// tight loop, so at most one rejection per REJECT_TRACE_INTERVAL_MS is traced
+// (with the number suppressed since) and nothing else is done for it.
+void rejectCurrentTimeWrite(CurrentTimeParseResult result, const uint8_t *data, size_t length)
+{
+  rejectedWriteCount++;
+  unsigned long nowMillis = millis();
+  if (rejectTraced && nowMillis - lastRejectTraceMillis < REJECT_TRACE_INTERVAL_MS)
+  {
+    suppressedRejectCount++;
+    return;
+  }
+  uint8_t traced = length < REJECT_TRACE_MAX_BYTES ? length : REJECT_TRACE_MAX_BYTES;
+  TRACE(WRITE_REJECTED, (uint8_t)result, suppressedRejectCount, TraceBytes{data, traced});
+  suppressedRejectCount = 0;
+  lastRejectTraceMillis = nowMillis;
+  rejectTraced = true;
+}
+
+// Handler for when the Current Time characteristic is written by a client
+void currentTimeWrittenHandler(const TransportPeer &central, GattCharacteristicId characteristic)
+{
+  PROFILE_SCOPE(CURRENT_TIME_WRITTEN);
+  size_t length;
+  const uint8_t *data = transportValue(characteristic, length);
+  ParsedCurrentTime parsed;
+  CurrentTimeParseResult result = parseCurrentTime(data, length, parsed);
+  if (result != CURRENT_TIME_OK)
+  {
+    rejectCurrentTimeWrite(result, data, length);
+    return;
+  }
+
+  acceptedWriteCount++;
+  connectionParams.onActivity(central.address(), millis());
+  TRACE(TIME_WRITTEN_BY, central.address());
+  // Log the raw received data (hex formatting happens on the host)
+  TRACE(RAW_DATA, TraceBytes{data, CtsCurrentTime::WIRE_SIZE});
+
+  uint8_t adjustReason = parsed.adjustReason;
+  if (adjustReason == CTS_ADJUST_NONE)
+  {
+    adjustReason = CTS_ADJUST_MANUAL; // A client write is an adjustment either way
+  }
+  applyReferenceTime(parsed, adjustReason);
+}
+
+// Scan report while a gateway scan window is open. Anything but a fresh,
+// correctly signed gateway broadcast with a plausible stamp is dropped
+// before touching the clock.
+void gatewayDiscoveredHandler(const TransportPeer &peripheral)
+{
+  uint8_t data[GATEWAY_TIME_LENGTH];
+  if (!peripheral.hasManufacturerData() || peripheral.manufacturerDataLength() != (int)sizeof(data))
+  {
+    return; // Most reports: other devices nearby
+  }
+  peripheral.manufacturerData(data, sizeof(data));
+  ParsedCurrentTime parsed;
+  TimeSnapshot time = readTime();
+  GatewayTimeResult result = gatewayTime.accept(data, sizeof(data), time.clock.epochSeconds(), time.synced, parsed);
+  if (result == GATEWAY_TIME_BAD_TAG || result == GATEWAY_TIME_OUT_OF_WINDOW)
+  {
+    TRACE(GATEWAY_TIME_REJECTED, peripheral.address(), (uint8_t)result);
+  }
+  if (result != GATEWAY_TIME_OK)
+  {
+    return;
+  }
+
+  TRACE(GATEWAY_TIME_ACCEPTED, peripheral.address(), gatewayTime.lastSequence());
+  applyReferenceTime(parsed, CTS_ADJUST_EXTERNAL_REFERENCE);
+  transportStopScan();
+  gatewayScanning = false;
+  tGatewayScan.restartDelayed(GATEWAY_SCAN_INTERVAL_MS);
+}
+
+void blePeripheralConnectHandler(const TransportPeer &central)
+{
+  TRACE(CONNECTED, central.address());
+  connectCount++;
+
+  // Check if already connected to avoid race conditions
+  if (connections.find(central.address()))
+  {
+    TRACE(ALREADY_CONNECTED);
+    return;
+  }
+  CentralConnection *connection = connections.add(central.address());
+  if (!connection)
+  {
+    TRACE(CONNECTION_TABLE_FULL, central.address());
+    transportDisconnect(central.address());
+    return;
+  }
+  TRACE(CONNECTION_ESTABLISHED);
+  connectionParams.onConnected(*connection, millis());
+  tConnectionIdle.restartDelayed(CONN_IDLE_AFTER_MS);
+  TRACE(CENTRALS_CONNECTED, connections.count(), (uint8_t)MAX_CENTRALS);
+
+  digitalWrite(LED_PIN, HIGH); // Turn LED on while any central is connected
+  ledState = HIGH;
+  tLedBlink.disable(); // Stop blinking when connected
+
+  // The stack stops advertising when a link is made; resume (at the slow
+  // interval) while slots remain so other centrals can still connect. A
+  // pending restart after a disconnect is dropped if this connection used
+  // the last slot.
+  advertising.stopped(true, millis());
+  tAdvertisingStep.disable();
+  advertiseBurst = false;
+  if (connections.full())
+  {
+    tRestartAdvertising.disable();
   }
   else
   {
-    Serial.println("Ignoring disconnect event, was not connected.");
+    tRestartAdvertising.restartDelayed(100);
+  }
+
+  // Update characteristics shortly after connection, without blocking:
+  // wait 50ms for the connection to stabilize, then one write per 10ms
+  tSendInitialCharacteristics.restartDelayed(50);
+}
+
+void blePeripheralDisconnectHandler(const TransportPeer &central)
+{
+  TRACE(DISCONNECTED, central.address());
+  disconnectCount++;
+
+  // Only act on centrals that are in the table
+  if (!connections.remove(central.address()))
+  {
+    TRACE(NOT_CONNECTED);
+    return;
+  }
+  TRACE(CONNECTION_TERMINATED);
+  TRACE(CENTRALS_CONNECTED, connections.count(), (uint8_t)MAX_CENTRALS);
+  updateSubscription();
+
+  if (connections.count() == 0)
+  {
+    digitalWrite(LED_PIN, LOW); // Turn LED off when the last central leaves
+    ledState = LOW;
+    tLedBlink.enable(); // Start blinking again
+    tSendInitialCharacteristics.disable();
   }
+
+  // Explicitly stop advertising before restarting with a fast burst
+  transportStopAdvertise();
+  advertising.stopped(false, millis());
+  tAdvertisingStep.disable();
+  TRACE(ADVERTISING_STOPPED);
+  advertiseBurst = true;
+  tRestartAdvertising.restartDelayed(100); // Short pause before restarting
 }
 
 // --- Setup ---
 void setup()
 {
   Serial.begin(9600);
+  logSetWakeHook(wakeLogDrain);
   // while (!Serial); // Wait for serial port to connect - Needed for some boards
   delay(1000); // Short delay for stability
-  Serial.println("Starting BLE CTS Server ver 1 : " DEVICE_NAME);
+  TRACE(BOOT, TraceString{DEVICE_NAME});
 
   pinMode(LED_PIN, OUTPUT);
   digitalWrite(LED_PIN, LOW); // Start with LED off
+#if CTS_PROFILER
+  profilerBegin();
+#endif
 
-  // Initialize BLE
-  if (!BLE.begin())
+  // Initialize BLE, named and with the services of GattTable.h (the CTS
+  // service is the advertised one)
+  if (!transportBegin(DEVICE_NAME))
   {
-    Serial.println("Starting BLE failed!");
+    TRACE(BLE_BEGIN_FAILED);
+    logFlush(); // Nothing drains the buffer once we halt
     while (1)
     { // Halt execution
       digitalWrite(LED_PIN, !digitalRead(LED_PIN));
@@ -399,65 +778,67 @@ void setup()
     }
   }
 
-  // Set BLE device name
-  BLE.setLocalName(DEVICE_NAME);
-  BLE.setDeviceName(DEVICE_NAME);
-
-  // Add characteristics to the service
-  ctsService.addCharacteristic(currentTimeChar);
-  ctsService.addCharacteristic(localTimeInfoChar);
-  ctsService.addCharacteristic(refTimeInfoChar);
-
-  // Add the service
-  BLE.addService(ctsService);
-
-  // Set advertised service UUID
-  BLE.setAdvertisedService(ctsService); // Advertise the service itself
-
   // Set initial characteristic values
-  lastTimeUpdateMillis = millis(); // Initialize time tracking
-  updateInternalTime();            // Set initial time struct values
-  writeCurrentTime();
+  timebaseBegin();
+  systemClock.begin(timebaseNow()); // Initialize time tracking
+  publishTime();
+  refreshCurrentTime();
   writeLocalTimeInfo();
   writeRefTimeInfo();
+  writeDiagnostics();
 
   // Assign event handlers
-  BLE.setEventHandler(BLEConnected, blePeripheralConnectHandler);
-  BLE.setEventHandler(BLEDisconnected, blePeripheralDisconnectHandler);
-
-  // Assign the written handler specifically for the currentTimeChar
-  currentTimeChar.setEventHandler(BLEWritten, currentTimeWrittenHandler);
-
-  // Set advertising parameters (optional, use defaults or customize)
-  BLE.setAdvertisingInterval(320); // Slower advertising interval: 200ms (320 * 0.625ms)
-  // Set connection parameters for stability (longer intervals)
-  // Min 30ms, Max 60ms. Supervision Timeout 4 seconds.
-  BLE.setConnectionInterval(0x0018, 0x0030); // 24 * 1.25ms = 30ms, 48 * 1.25ms = 60ms
-  BLE.setSupervisionTimeout(400);            // 400 * 10ms = 4000ms = 4s
-
-  // Start advertising
-  if (BLE.advertise())
+  transportSetPeerHandler(TRANSPORT_CONNECTED, blePeripheralConnectHandler);
+  transportSetPeerHandler(TRANSPORT_DISCONNECTED, blePeripheralDisconnectHandler);
+
+  // Assign the written handler specifically for Current Time
+  transportSetCharacteristicHandler(GATT_CURRENT_TIME, TRANSPORT_WRITTEN, currentTimeWrittenHandler);
+  transportSetCharacteristicHandler(GATT_CURRENT_TIME, TRANSPORT_READ, currentTimeReadHandler);
+  transportSetCharacteristicHandler(GATT_REFERENCE_TIME_INFO, TRANSPORT_READ, refTimeInfoReadHandler);
+  transportSetCharacteristicHandler(GATT_CURRENT_TIME, TRANSPORT_SUBSCRIBED, currentTimeSubscribedHandler);
+  transportSetCharacteristicHandler(GATT_CURRENT_TIME, TRANSPORT_UNSUBSCRIBED, currentTimeUnsubscribedHandler);
+#if !CTS_BLE_THREAD
+  transportSetCharacteristicHandler(GATT_DIAGNOSTICS, TRANSPORT_READ, diagnosticsReadHandler);
+#endif
+#if CTS_GATEWAY_TIME
+  transportSetPeerHandler(TRANSPORT_DISCOVERED, gatewayDiscoveredHandler); // tGatewayScan opens the first window
+#endif
+
+  // Preferred connection parameters for new links: the SYNC profile (see
+  // CONNECTION_PROFILES in ConnectionParams.h)
+  connectionParams.begin();
+
+  // Start advertising with the fast phase (see ADVERTISING_PHASES in
+  // AdvertisingScheduler.h); tAdvertisingStep backs the interval off
+  updateTimeBeacon();
+  scheduleAdvertisingStep(advertising.start(true, millis()));
+  if (advertising.active())
   {
-    Serial.println("Advertising started");
-    Serial.print("MAC Address: ");
-    Serial.println(BLE.address());
+    TRACE(ADVERTISING_STARTED);
+    TRACE(MAC_ADDRESS, TraceString{transportAddress().c_str()});
   }
   else
   {
-    Serial.println("Advertising failed to start!");
+    TRACE(ADVERTISING_FAILED);
     // Handle error, maybe retry or halt
   }
 
   // Initialize Task Scheduler runner (already done by task creation)
-  Serial.println("Setup complete. Running tasks...");
+  TRACE(SETUP_COMPLETE);
 }
 
 // --- Loop ---
 void loop()
 {
+#if CTS_TICKLESS
+  // Execute due tasks, then sleep until the next deadline or a radio event
+  runScheduler();
+  idle.sleep();
+#else
   // Execute scheduled tasks
-  ts.execute();
+  runScheduler();
 
   // Add a small delay if loop runs too fast, can sometimes help stability
   // delay(1); // Uncomment if needed, but tBlePoll should handle polling sufficiently
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+"""原生模擬的回歸情境：逐一建置並執行，任一情境失敗時以非零狀態結束。
+
+每個情境都是某個 native 環境的程式加上判定門檻的參數（--max-offset-ms、
+--max-notifications），由程式本身的結束碼決定成敗：
+    python test/sim_scenarios.py                  # pio run 後執行全部情境
+    python test/sim_scenarios.py --no-build       # 使用已建置的程式
+    python test/sim_scenarios.py gateway rtc      # 只執行指定情境
+門檻之外的數值為撰寫時的實測結果，列在各情境的說明中供比對。
+"""
+import argparse
+import os
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.join(HERE, "..")
+GATEWAY_SCRIPT = os.path.join(ROOT, "python_cts_client", "gateway.py")
+
+# (名稱, PlatformIO 環境, 程式參數, 標準輸入來源指令或 None, 說明)
+SCENARIOS = [
+    ("sync", "native",
+     ["--days", "28", "--sync-hours", "24", "--drift-ppm", "40", "--max-offset-ms", "10"], None,
+     "28 天、每日校時、+40 ppm 漂移：約 -6 ms"),
+    ("rtc", "native_rtc",
+     ["--days", "28", "--sync-hours", "24", "--drift-ppm", "40", "--max-offset-ms", "10"], None,
+     "同上，改用模擬的 nRF52 RTC 時基：約 -3 ms"),
+    ("gateway", "native_gateway",
+     ["--gateway", "--days", "2", "--drift-ppm", "40", "--max-offset-ms", "10"],
+     [sys.executable, GATEWAY_SCRIPT, "--sim", "--hours", "49"],
+     "只由閘道廣播校時 2 天：約 -4 ms"),
+    ("notifications", "native_loopback",
+     ["--ops", "100000", "--centrals", "3", "--max-notifications", "12000"], None,
+     "3 個訂閱者、10 萬次外部參考校時寫入與讀取：11451 則通知（讀取也通知時為 311454）"),
+]
+
+
+def program_path(build_dir, env):
+    return os.path.join(build_dir, env, "program")
+
+
+def run_scenario(build_dir, scenario):
+    """執行一個情境，回傳是否通過。"""
+    name, env, args, feeder, description = scenario
+    print("== %s (%s): %s" % (name, env, description), flush=True)
+    command = [program_path(build_dir, env)] + args
+    if feeder is None:
+        result = subprocess.run(command, cwd=ROOT)
+        return result.returncode == 0
+    source = subprocess.Popen(feeder, cwd=ROOT, stdout=subprocess.PIPE)
+    result = subprocess.run(command, cwd=ROOT, stdin=source.stdout)
+    source.stdout.close()
+    source.wait()
+    return result.returncode == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="原生模擬的回歸情境")
+    parser.add_argument("names", nargs="*", help="只執行這些情境（預設全部）")
+    parser.add_argument("--no-build", action="store_true", help="不執行 pio run，直接使用已建置的程式")
+    parser.add_argument("--build-dir", default=os.path.join(ROOT, ".pio", "build"), help="各環境建置結果所在目錄")
+    args = parser.parse_args()
+
+    unknown = set(args.names) - set(s[0] for s in SCENARIOS)
+    if unknown:
+        parser.error("沒有這些情境：%s" % ", ".join(sorted(unknown)))
+    scenarios = [s for s in SCENARIOS if not args.names or s[0] in args.names]
+
+    if not args.no_build:
+        for env in sorted(set(s[1] for s in scenarios)):
+            if subprocess.run(["pio", "run", "-e", env], cwd=ROOT).returncode != 0:
+                print("建置 %s 失敗" % env)
+                sys.exit(1)
+
+    failed = [s[0] for s in scenarios if not run_scenario(args.build_dir, s)]
+    print("%d/%d 個情境通過" % (len(scenarios) - len(failed), len(scenarios)))
+    if failed:
+        print("失敗：%s" % ", ".join(failed))
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()